@@ -34,6 +34,7 @@
 #include "tcg/tcg.h"
 #include "qemu/atomic.h"
 #include "qemu/rcu.h"
+#include "qemu/timer.h"
 #include "exec/log.h"
 #include "qemu/main-loop.h"
 #include "exec/icount.h"
@@ -227,34 +228,67 @@ static TranslationBlock *tb_htable_lookup(CPUState *cpu, TCGTBCPUState s)
  *
  * Returns: an existing translation block or NULL.
  */
+/*
+ * Insert @tb for @pc as the most recently used entry of its set in
+ * @cpu's jump cache, dropping the least recently used one.
+ */
+static inline void tb_jmp_cache_insert(CPUState *cpu, vaddr pc,
+                                       TranslationBlock *tb)
+{
+    CPUJumpCache *jc = cpu->tb_jmp_cache;
+    unsigned int set = tb_jmp_cache_hash_func(jc, pc) * jc->ways;
+    unsigned int way;
+
+    for (way = jc->ways - 1; way > 0; way--) {
+        jc->array[set + way].pc = jc->array[set + way - 1].pc;
+        qatomic_set(&jc->array[set + way].tb,
+                    qatomic_read(&jc->array[set + way - 1].tb));
+    }
+    jc->array[set].pc = pc;
+    qatomic_set(&jc->array[set].tb, tb);
+}
+
 static inline TranslationBlock *tb_lookup(CPUState *cpu, TCGTBCPUState s)
 {
     TranslationBlock *tb;
     CPUJumpCache *jc;
-    uint32_t hash;
+    unsigned int set, way;
 
     /* we should never be trying to look up an INVALID tb */
     tcg_debug_assert(!(s.cflags & CF_INVALID));
 
-    hash = tb_jmp_cache_hash_func(s.pc);
     jc = cpu->tb_jmp_cache;
-
-    tb = qatomic_read(&jc->array[hash].tb);
-    if (likely(tb &&
-               jc->array[hash].pc == s.pc &&
-               tb->cs_base == s.cs_base &&
-               tb->flags == s.flags &&
-               tb_cflags(tb) == s.cflags)) {
-        goto hit;
+    set = tb_jmp_cache_hash_func(jc, s.pc) * jc->ways;
+
+    for (way = 0; way < jc->ways; way++) {
+        tb = qatomic_read(&jc->array[set + way].tb);
+        if (likely(tb &&
+                   jc->array[set + way].pc == s.pc &&
+                   tb->cs_base == s.cs_base &&
+                   tb->flags == s.flags &&
+                   tb_cflags(tb) == s.cflags)) {
+            if (way) {
+                /* Swap with the most recently used entry of the set. */
+                TranslationBlock *mru = qatomic_read(&jc->array[set].tb);
+
+                jc->array[set + way].pc = jc->array[set].pc;
+                qatomic_set(&jc->array[set + way].tb, mru);
+                jc->array[set].pc = s.pc;
+                qatomic_set(&jc->array[set].tb, tb);
+            }
+            qatomic_set(&jc->hits, jc->hits + 1);
+            goto hit;
+        }
     }
 
     tb = tb_htable_lookup(cpu, s);
     if (tb == NULL) {
+        qatomic_set(&jc->misses, jc->misses + 1);
         return NULL;
     }
 
-    jc->array[hash].pc = s.pc;
-    qatomic_set(&jc->array[hash].tb, tb);
+    qatomic_set(&jc->htable_hits, jc->htable_hits + 1);
+    tb_jmp_cache_insert(cpu, s.pc, tb);
 
 hit:
     /*
@@ -407,6 +441,132 @@ const void *HELPER(lookup_tb_ptr)(CPUArchState *env)
     return tb->tc.ptr;
 }
 
+/**
+ * helper_lookup_tb_ptr_ic: fill an inline cache for an indirect branch
+ * @env: current cpu state
+ * @ptr: the TB holding the inline cache
+ * @idx: the inline cache within @ptr, TB_IC_JMP or TB_IC_RET
+ *
+ * As helper_lookup_tb_ptr, and record the TB found in the inline cache,
+ * so that the next jump to the same pc skips the lookup.  Only TBs with
+ * the same flags as @ptr are recorded: the generated code does not check
+ * the cpu state, which the jump is required not to change.
+ *
+ * tb_evict_count only changes while no vCPU runs, so it is stable here.
+ * Fills from several vCPUs may race, and may then leave the same TB in
+ * two entries or drop one; both are harmless.
+ */
+const void *HELPER(lookup_tb_ptr_ic)(CPUArchState *env, void *ptr,
+                                     uint32_t idx)
+{
+    CPUState *cpu = env_cpu(env);
+    CPUJumpCache *jc = cpu->tb_jmp_cache;
+    TranslationBlock *owner = ptr;
+    TBInlineCache *ic = &owner->ic[idx];
+    uint32_t gen = qatomic_read(&tb_ctx.tb_evict_count);
+    TranslationBlock *tb;
+
+    cpu->neg.can_do_io = true;
+
+    TCGTBCPUState s = cpu->cc->tcg_ops->get_tb_cpu_state(cpu);
+    s.cflags = curr_cflags(cpu);
+
+    if (check_for_breakpoints(cpu, s.pc, &s.cflags)) {
+        cpu_loop_exit(cpu);
+    }
+
+    qatomic_set(&jc->ic_misses, jc->ic_misses + 1);
+    tb = tb_lookup(cpu, s);
+    if (tb == NULL) {
+        return tcg_code_gen_epilogue;
+    }
+
+    if (qemu_loglevel_mask(CPU_LOG_TB_CPU | CPU_LOG_EXEC)) {
+        /* Keep every TB visible in the log. */
+        log_cpu_exec(s.pc, cpu, tb);
+        return tb->tc.ptr;
+    }
+
+    if (QTAILQ_EMPTY(&cpu->breakpoints) &&
+        tb->flags == owner->flags && tb->cs_base == owner->cs_base &&
+        tb_cflags(tb) == tb_cflags(owner)) {
+        int i;
+
+        if (qatomic_read(&ic->gen) != gen) {
+            /* The entries may point to reclaimed memory: drop them all. */
+            for (i = 0; i < TB_IC_WAYS; i++) {
+                qatomic_set(&ic->tb[i], NULL);
+            }
+            smp_wmb();
+            qatomic_set(&ic->gen, gen);
+        }
+        for (i = TB_IC_WAYS - 1; i > 0; i--) {
+            qatomic_set(&ic->tb[i], qatomic_read(&ic->tb[i - 1]));
+        }
+        qatomic_set(&ic->tb[0], tb);
+    }
+
+    return tb->tc.ptr;
+}
+
+/**
+ * helper_tb_tier_up: retranslate a hot TB as a trace
+ * @env: current cpu state
+ * @ptr: the tier-0 TB, which has not started executing
+ *
+ * Called at the start of a TB whose execution count reached the tier
+ * threshold.  Unlink and drop the TB, then request that the next TB be
+ * translated with CF_TRACE.  The caller exits with TB_EXIT_REQUESTED,
+ * which resynchronizes the pc from @ptr.
+ *
+ * The count is reset, so that the TB does not come back here if it is
+ * still entered, nor other TBs hashed to the same counter.  Another vCPU
+ * may have dropped the TB already, and is then translating the trace.
+ */
+void HELPER(tb_tier_up)(CPUArchState *env, void *ptr)
+{
+    CPUState *cpu = env_cpu(env);
+    TranslationBlock *tb = ptr;
+
+    cpu->tb_exec_count[tb_exec_count_slot(tb)] = 0;
+
+    mmap_lock();
+    if (!(tb_cflags(tb) & CF_INVALID)) {
+        tb_phys_invalidate(tb, -1);
+        qatomic_inc(&tb_ctx.tb_tier_up_count);
+        cpu->cflags_next_tb = curr_cflags(cpu) | CF_TRACE;
+    }
+    mmap_unlock();
+
+    /* Make cpu_loop_exec_tb treat the exit as a request, not icount. */
+    qatomic_set(&cpu->neg.icount_decr.u16.high, -1);
+}
+
+/* Number of times code buffer space was reclaimed, by eviction or flush */
+static inline unsigned tb_reclaim_count(void)
+{
+    return qatomic_read(&tb_ctx.tb_flush_count) +
+           qatomic_read(&tb_ctx.tb_evict_count);
+}
+
+/*
+ * Translate a TB on a lookup miss.  The vCPU stalls for the duration,
+ * which is accounted to it for "info jit".
+ */
+static TranslationBlock *tb_gen_code_stalled(CPUState *cpu, TCGTBCPUState s)
+{
+    int64_t start = get_clock();
+    TranslationBlock *tb;
+
+    mmap_lock();
+    tb = tb_gen_code(cpu, s);
+    mmap_unlock();
+
+    qatomic_set(&cpu->tb_gen_ns, cpu->tb_gen_ns + (get_clock() - start));
+    qatomic_set(&cpu->tb_gen_count, cpu->tb_gen_count + 1);
+    return tb;
+}
+
 /* Return the current PC from CPU, which may be cached in TB. */
 static vaddr log_pc(CPUState *cpu, const TranslationBlock *tb)
 {
@@ -567,6 +727,7 @@ void cpu_exec_step_atomic(CPUState *cpu)
         s.cflags &= ~CF_PARALLEL;
         /* After 1 insn, return and release the exclusive lock. */
         s.cflags |= CF_NO_GOTO_TB | CF_NO_GOTO_PTR | 1;
+        trace_cpu_exec_step_atomic(cpu->cpu_index, s.pc);
         /*
          * No need to check_for_breakpoints here.
          * We only arrive in cpu_exec_step_atomic after beginning execution
@@ -574,11 +735,17 @@ void cpu_exec_step_atomic(CPUState *cpu)
          * Any breakpoint for this insn will have been recognized earlier.
          */
 
+#ifndef CONFIG_USER_ONLY
+        /*
+         * The other cpus are stopped, but may have queued TLB flushes
+         * for us before; they must be applied before the insn runs.
+         */
+        tlb_flush_pending(cpu);
+#endif
+
         tb = tb_lookup(cpu, s);
         if (tb == NULL) {
-            mmap_lock();
-            tb = tb_gen_code(cpu, s);
-            mmap_unlock();
+            tb = tb_gen_code_stalled(cpu, s);
         }
 
         cpu_exec_enter(cpu);
@@ -800,6 +967,8 @@ static inline bool cpu_handle_interrupt(CPUState *cpu,
 #ifdef CONFIG_USER_ONLY
     assert(!cpu_test_interrupt(cpu, ~0));
 #else
+    tlb_flush_pending(cpu);
+
     if (unlikely(cpu_test_interrupt(cpu, ~0))) {
         bql_lock();
         if (cpu_test_interrupt(cpu, CPU_INTERRUPT_DEBUG)) {
@@ -966,21 +1135,24 @@ cpu_exec_loop(CPUState *cpu, SyncClocks *sc)
 
             tb = tb_lookup(cpu, s);
             if (tb == NULL) {
-                CPUJumpCache *jc;
-                uint32_t h;
+                unsigned reclaim_count = tb_reclaim_count();
+
+                tb = tb_gen_code_stalled(cpu, s);
 
-                mmap_lock();
-                tb = tb_gen_code(cpu, s);
-                mmap_unlock();
+                /*
+                 * In serial context, tb_gen_code may have evicted or
+                 * flushed the code holding last_tb to make room: the TB
+                 * we come from is gone, do not link it.
+                 */
+                if (tb_reclaim_count() != reclaim_count) {
+                    last_tb = NULL;
+                }
 
                 /*
                  * We add the TB in the virtual pc hash table
                  * for the fast lookup
                  */
-                h = tb_jmp_cache_hash_func(s.pc);
-                jc = cpu->tb_jmp_cache;
-                jc->array[h].pc = s.pc;
-                qatomic_set(&jc->array[h].tb, tb);
+                tb_jmp_cache_insert(cpu, s.pc, tb);
             }
 
 #ifndef CONFIG_USER_ONLY
@@ -1068,7 +1240,12 @@ bool tcg_exec_realizefn(CPUState *cpu, Error **errp)
         tcg_target_initialized = true;
     }
 
-    cpu->tb_jmp_cache = g_new0(CPUJumpCache, 1);
+    cpu->tb_jmp_cache = g_malloc0(sizeof(CPUJumpCache) +
+                                  sizeof(cpu->tb_jmp_cache->array[0]) *
+                                  jmp_cache_size);
+    cpu->tb_jmp_cache->ways = jmp_cache_ways;
+    cpu->tb_jmp_cache->bits = ctz32(jmp_cache_size / jmp_cache_ways);
+    cpu->tb_exec_count = g_new0(uint32_t, TB_EXEC_COUNT_SIZE);
     tlb_init(cpu);
 #ifndef CONFIG_USER_ONLY
     tcg_iommu_init_notifier_list(cpu);
@@ -1087,4 +1264,6 @@ void tcg_exec_unrealizefn(CPUState *cpu)
 
     tlb_destroy(cpu);
     g_free_rcu(cpu->tb_jmp_cache, rcu);
+    g_free(cpu->tb_exec_count);
+    cpu->tb_exec_count = NULL;
 }
@@ -149,14 +149,16 @@ static void tlb_window_reset(CPUTLBDesc *desc, int64_t ns,
 static void tb_jmp_cache_clear_page(CPUState *cpu, vaddr page_addr)
 {
     CPUJumpCache *jc = cpu->tb_jmp_cache;
-    int i, i0;
+    unsigned int i, i0, n;
 
     if (unlikely(!jc)) {
         return;
     }
 
-    i0 = tb_jmp_cache_hash_page(page_addr);
-    for (i = 0; i < TB_JMP_PAGE_SIZE; i++) {
+    /* The sets of a page are consecutive, and so are their entries. */
+    i0 = tb_jmp_cache_hash_page(jc, page_addr) * jc->ways;
+    n = jc->ways << tb_jmp_cache_page_bits(jc);
+    for (i = 0; i < n; i++) {
         qatomic_set(&jc->array[i0 + i].tb, NULL);
     }
 }
@@ -282,6 +284,10 @@ static void tlb_mmu_flush_locked(CPUTLBDesc *desc, CPUTLBDescFast *fast)
     desc->large_page_addr = -1;
     desc->large_page_mask = -1;
     desc->vindex = 0;
+    desc->lindex = 0;
+    for (int i = 0; i < CPU_LTLB_SIZE; i++) {
+        desc->ltable[i].addr = -1;
+    }
     memset(fast->table, -1, sizeof_tlb(fast));
     memset(desc->vtable, -1, sizeof(desc->vtable));
 }
@@ -347,23 +353,77 @@ void tlb_destroy(CPUState *cpu)
     }
 }
 
-/* flush_all_helper: run fn across all cpus
- *
- * If the wait flag is set then the src cpu's helper will be queued as
- * "safe" work and the loop exited creating a synchronisation point
- * where all queued work will be finished before execution starts
- * again.
+typedef CPUTLBPendingRange TLBFlushRangeData;
+
+/*
+ * Queue a flush of the @full mmu indexes and of the range @d, if any,
+ * on @cpu.  Ranges with the same mmu indexes and significant bits are
+ * merged when they overlap or touch; when the queue is full, the range
+ * degrades into a flush of its mmu indexes.
  */
-static void flush_all_helper(CPUState *src, run_on_cpu_func fn,
-                             run_on_cpu_data d)
+static void tlb_queue_flush_locked(CPUState *cpu, MMUIdxMap full,
+                                   const TLBFlushRangeData *d)
+{
+    CPUTLBCommon *c = &cpu->neg.tlb.c;
+
+    c->pending_full |= full;
+
+    if (d && (d->idxmap & ~c->pending_full)) {
+        /* Use the last byte, as the end of a range may wrap to 0. */
+        vaddr first = d->addr, last = d->addr + d->len - 1;
+        unsigned i;
+
+        for (i = 0; i < c->pending_nb_ranges; i++) {
+            TLBFlushRangeData *r = &c->pending_range[i];
+            vaddr r_last = r->addr + r->len - 1;
+
+            if (r->idxmap == d->idxmap && r->bits == d->bits &&
+                (first <= r_last || first - r_last == 1) &&
+                (r->addr <= last || r->addr - last == 1)) {
+                first = MIN(first, r->addr);
+                last = MAX(last, r_last);
+                if (last - first == (vaddr)-1) {
+                    /* The whole address space: len cannot express it. */
+                    c->pending_full |= d->idxmap;
+                } else {
+                    r->addr = first;
+                    r->len = last - first + 1;
+                }
+                break;
+            }
+        }
+        if (i == c->pending_nb_ranges) {
+            if (i < CPU_TLB_PENDING_RANGES) {
+                c->pending_range[i] = *d;
+                c->pending_nb_ranges = i + 1;
+            } else {
+                c->pending_full |= d->idxmap;
+            }
+        }
+    }
+
+    qatomic_set(&c->pending_req, c->pending_req + 1);
+}
+
+/*
+ * Queue the flush on every cpu, including @src, and make them leave
+ * their chain of TBs so that the queue is drained promptly; see
+ * tlb_flush_pending.  @src then waits for the others before
+ * executing further, which provides the "synced" semantics without
+ * an exclusive section.
+ */
+static void tlb_flush_all_cpus_queue(CPUState *src, MMUIdxMap full,
+                                     const TLBFlushRangeData *d)
 {
     CPUState *cpu;
 
     CPU_FOREACH(cpu) {
-        if (cpu != src) {
-            async_run_on_cpu(cpu, fn, d);
-        }
+        qemu_spin_lock(&cpu->neg.tlb.c.lock);
+        tlb_queue_flush_locked(cpu, full, d);
+        qemu_spin_unlock(&cpu->neg.tlb.c.lock);
+        qatomic_set(&cpu->neg.icount_decr.u16.high, -1);
     }
+    qatomic_set(&src->neg.tlb.c.sync_wait, true);
 }
 
 static void tlb_flush_by_mmuidx_async_work(CPUState *cpu, run_on_cpu_data data)
@@ -422,12 +482,9 @@ void tlb_flush(CPUState *cpu)
 
 void tlb_flush_by_mmuidx_all_cpus_synced(CPUState *src_cpu, MMUIdxMap idxmap)
 {
-    const run_on_cpu_func fn = tlb_flush_by_mmuidx_async_work;
-
     tlb_debug("mmu_idx: 0x%"PRIx16"\n", idxmap);
 
-    flush_all_helper(src_cpu, fn, RUN_ON_CPU_HOST_INT(idxmap));
-    async_safe_run_on_cpu(src_cpu, fn, RUN_ON_CPU_HOST_INT(idxmap));
+    tlb_flush_all_cpus_queue(src_cpu, idxmap, NULL);
 }
 
 void tlb_flush_all_cpus_synced(CPUState *src_cpu)
@@ -499,6 +556,69 @@ static inline void tlb_flush_vtlb_page_locked(CPUState *cpu, int mmu_idx,
     tlb_flush_vtlb_page_mask_locked(cpu, mmu_idx, page, -1);
 }
 
+/*
+ * Flush all of the target pages filled from the large page @lp,
+ * and release it.  Called with tlb_c.lock held.
+ */
+static void tlb_flush_large_page_locked(CPUState *cpu, int midx,
+                                        CPUTLBLargePage *lp)
+{
+    CPUTLBDescFast *f = cpu_tlb_fast(cpu, midx);
+    size_t n_entries = tlb_n_entries(f);
+    vaddr len = ~lp->mask + 1;
+    /* Do not match empty entries, or comparators that are invalid. */
+    vaddr mask = lp->mask | TLB_INVALID_MASK;
+
+    tlb_debug("large page midx %d (%016" VADDR_PRIx "/%016" VADDR_PRIx ")\n",
+              midx, lp->addr, lp->mask);
+
+    if ((len >> TARGET_PAGE_BITS) <= n_entries) {
+        for (vaddr i = 0; i < len; i += TARGET_PAGE_SIZE) {
+            vaddr page = lp->addr + i;
+
+            if (tlb_flush_entry_locked(tlb_entry(cpu, midx, page), page)) {
+                tlb_n_used_entries_dec(cpu, midx);
+            }
+        }
+    } else {
+        /* The page has more target pages than the tlb has entries. */
+        for (size_t i = 0; i < n_entries; i++) {
+            if (tlb_flush_entry_mask_locked(&f->table[i], lp->addr, mask)) {
+                tlb_n_used_entries_dec(cpu, midx);
+            }
+        }
+    }
+    tlb_flush_vtlb_page_mask_locked(cpu, midx, lp->addr, mask);
+    lp->addr = -1;
+}
+
+/*
+ * Flush each large page in the large page table which overlaps
+ * [@addr, @addr + @len) when compared under @mask.
+ * Called with tlb_c.lock held.
+ */
+static void tlb_flush_large_pages_locked(CPUState *cpu, int midx,
+                                         vaddr addr, vaddr len, vaddr mask)
+{
+    CPUTLBDesc *d = &cpu->neg.tlb.d[midx];
+    vaddr last = (addr + len - 1) & mask;
+
+    addr &= mask;
+    for (int i = 0; i < CPU_LTLB_SIZE; i++) {
+        CPUTLBLargePage *lp = &d->ltable[i];
+
+        if (lp->addr == (vaddr)-1) {
+            continue;
+        }
+        /* Be conservative if the comparison under @mask would wrap. */
+        if ((~lp->mask & ~mask) || last < addr ||
+            (addr <= ((lp->addr | ~lp->mask) & mask) &&
+             (lp->addr & mask) <= last)) {
+            tlb_flush_large_page_locked(cpu, midx, lp);
+        }
+    }
+}
+
 static void tlb_flush_page_locked(CPUState *cpu, int midx, vaddr page)
 {
     vaddr lp_addr = cpu->neg.tlb.d[midx].large_page_addr;
@@ -511,6 +631,7 @@ static void tlb_flush_page_locked(CPUState *cpu, int midx, vaddr page)
                   midx, lp_addr, lp_mask);
         tlb_flush_one_mmuidx_locked(cpu, midx, get_clock_realtime());
     } else {
+        tlb_flush_large_pages_locked(cpu, midx, page, TARGET_PAGE_SIZE, -1);
         if (tlb_flush_entry_locked(tlb_entry(cpu, midx, page), page)) {
             tlb_n_used_entries_dec(cpu, midx);
         }
@@ -553,50 +674,6 @@ static void tlb_flush_page_by_mmuidx_async_0(CPUState *cpu,
     tb_jmp_cache_clear_page(cpu, addr);
 }
 
-/**
- * tlb_flush_page_by_mmuidx_async_1:
- * @cpu: cpu on which to flush
- * @data: encoded addr + idxmap
- *
- * Helper for tlb_flush_page_by_mmuidx and friends, called through
- * async_run_on_cpu.  The idxmap parameter is encoded in the page
- * offset of the target_ptr field.  This limits the set of mmu_idx
- * that can be passed via this method.
- */
-static void tlb_flush_page_by_mmuidx_async_1(CPUState *cpu,
-                                             run_on_cpu_data data)
-{
-    vaddr addr_and_idxmap = data.target_ptr;
-    vaddr addr = addr_and_idxmap & TARGET_PAGE_MASK;
-    MMUIdxMap idxmap = addr_and_idxmap & ~TARGET_PAGE_MASK;
-
-    tlb_flush_page_by_mmuidx_async_0(cpu, addr, idxmap);
-}
-
-typedef struct {
-    vaddr addr;
-    MMUIdxMap idxmap;
-} TLBFlushPageByMMUIdxData;
-
-/**
- * tlb_flush_page_by_mmuidx_async_2:
- * @cpu: cpu on which to flush
- * @data: allocated addr + idxmap
- *
- * Helper for tlb_flush_page_by_mmuidx and friends, called through
- * async_run_on_cpu.  The addr+idxmap parameters are stored in a
- * TLBFlushPageByMMUIdxData structure that has been allocated
- * specifically for this helper.  Free the structure when done.
- */
-static void tlb_flush_page_by_mmuidx_async_2(CPUState *cpu,
-                                             run_on_cpu_data data)
-{
-    TLBFlushPageByMMUIdxData *d = data.host_ptr;
-
-    tlb_flush_page_by_mmuidx_async_0(cpu, d->addr, d->idxmap);
-    g_free(d);
-}
-
 void tlb_flush_page_by_mmuidx(CPUState *cpu, vaddr addr, MMUIdxMap idxmap)
 {
     tlb_debug("addr: %016" VADDR_PRIx " mmu_idx:%" PRIx16 "\n", addr, idxmap);
@@ -618,41 +695,17 @@ void tlb_flush_page_by_mmuidx_all_cpus_synced(CPUState *src_cpu,
                                               vaddr addr,
                                               MMUIdxMap idxmap)
 {
+    TLBFlushRangeData d;
+
     tlb_debug("addr: %016" VADDR_PRIx " mmu_idx:%"PRIx16"\n", addr, idxmap);
 
     /* This should already be page aligned */
-    addr &= TARGET_PAGE_MASK;
-
-    /*
-     * Allocate memory to hold addr+idxmap only when needed.
-     * See tlb_flush_page_by_mmuidx for details.
-     */
-    if (idxmap < TARGET_PAGE_SIZE) {
-        flush_all_helper(src_cpu, tlb_flush_page_by_mmuidx_async_1,
-                         RUN_ON_CPU_TARGET_PTR(addr | idxmap));
-        async_safe_run_on_cpu(src_cpu, tlb_flush_page_by_mmuidx_async_1,
-                              RUN_ON_CPU_TARGET_PTR(addr | idxmap));
-    } else {
-        CPUState *dst_cpu;
-        TLBFlushPageByMMUIdxData *d;
-
-        /* Allocate a separate data block for each destination cpu.  */
-        CPU_FOREACH(dst_cpu) {
-            if (dst_cpu != src_cpu) {
-                d = g_new(TLBFlushPageByMMUIdxData, 1);
-                d->addr = addr;
-                d->idxmap = idxmap;
-                async_run_on_cpu(dst_cpu, tlb_flush_page_by_mmuidx_async_2,
-                                 RUN_ON_CPU_HOST_PTR(d));
-            }
-        }
+    d.addr = addr & TARGET_PAGE_MASK;
+    d.len = TARGET_PAGE_SIZE;
+    d.idxmap = idxmap;
+    d.bits = target_long_bits();
 
-        d = g_new(TLBFlushPageByMMUIdxData, 1);
-        d->addr = addr;
-        d->idxmap = idxmap;
-        async_safe_run_on_cpu(src_cpu, tlb_flush_page_by_mmuidx_async_2,
-                              RUN_ON_CPU_HOST_PTR(d));
-    }
+    tlb_flush_all_cpus_queue(src_cpu, 0, &d);
 }
 
 void tlb_flush_page_all_cpus_synced(CPUState *src, vaddr addr)
@@ -699,6 +752,8 @@ static void tlb_flush_range_locked(CPUState *cpu, int midx,
         return;
     }
 
+    tlb_flush_large_pages_locked(cpu, midx, addr, len, mask);
+
     for (vaddr i = 0; i < len; i += TARGET_PAGE_SIZE) {
         vaddr page = addr + i;
         CPUTLBEntry *entry = tlb_entry(cpu, midx, page);
@@ -710,13 +765,6 @@ static void tlb_flush_range_locked(CPUState *cpu, int midx,
     }
 }
 
-typedef struct {
-    vaddr addr;
-    vaddr len;
-    MMUIdxMap idxmap;
-    unsigned bits;
-} TLBFlushRangeData;
-
 static void tlb_flush_range_by_mmuidx_async_0(CPUState *cpu,
                                               TLBFlushRangeData d)
 {
@@ -739,7 +787,7 @@ static void tlb_flush_range_by_mmuidx_async_0(CPUState *cpu,
      * If the length is larger than the jump cache size, then it will take
      * longer to clear each entry individually than it will to clear it all.
      */
-    if (d.len >= (TARGET_PAGE_SIZE * TB_JMP_CACHE_SIZE)) {
+    if (d.len >= TARGET_PAGE_SIZE * tb_jmp_cache_entries(cpu->tb_jmp_cache)) {
         tcg_flush_jmp_cache(cpu);
         return;
     }
@@ -755,12 +803,89 @@ static void tlb_flush_range_by_mmuidx_async_0(CPUState *cpu,
     }
 }
 
-static void tlb_flush_range_by_mmuidx_async_1(CPUState *cpu,
-                                              run_on_cpu_data data)
+/* Apply the flushes queued on @cpu by tlb_flush_all_cpus_queue. */
+static void tlb_drain_pending(CPUState *cpu)
 {
-    TLBFlushRangeData *d = data.host_ptr;
-    tlb_flush_range_by_mmuidx_async_0(cpu, *d);
-    g_free(d);
+    CPUTLBCommon *c = &cpu->neg.tlb.c;
+    TLBFlushRangeData range[CPU_TLB_PENDING_RANGES];
+    MMUIdxMap full;
+    unsigned n;
+    uint32_t req;
+
+    qemu_spin_lock(&c->lock);
+    full = c->pending_full;
+    n = c->pending_nb_ranges;
+    memcpy(range, c->pending_range, n * sizeof(range[0]));
+    req = c->pending_req;
+    c->pending_full = 0;
+    c->pending_nb_ranges = 0;
+    qemu_spin_unlock(&c->lock);
+
+    if (full) {
+        tlb_flush_by_mmuidx_async_work(cpu, RUN_ON_CPU_HOST_INT(full));
+    }
+    for (unsigned i = 0; i < n; i++) {
+        TLBFlushRangeData d = range[i];
+
+        d.idxmap &= ~full;
+        if (d.idxmap == 0) {
+            continue;
+        }
+        if (d.len == TARGET_PAGE_SIZE && d.bits >= target_long_bits()) {
+            tlb_flush_page_by_mmuidx_async_0(cpu, d.addr, d.idxmap);
+        } else {
+            tlb_flush_range_by_mmuidx_async_0(cpu, d);
+        }
+    }
+
+    qatomic_store_release(&c->pending_ack, req);
+}
+
+/*
+ * Wait until every other cpu has drained the flushes queued so far,
+ * or is not executing; a cpu entering cpu_exec drains its queue
+ * before running any TB.  Keep draining our own queue meanwhile, as
+ * another cpu may be waiting for us in turn.
+ */
+static void tlb_sync_wait(CPUState *cpu)
+{
+    CPUTLBCommon *c = &cpu->neg.tlb.c;
+    CPUState *other;
+
+    qatomic_set(&c->sync_wait, false);
+
+    /* Order the queueing before reading other->running; see cpu_exec_start */
+    smp_mb();
+
+    CPU_FOREACH(other) {
+        CPUTLBCommon *oc = &other->neg.tlb.c;
+        uint32_t req = qatomic_read(&oc->pending_req);
+
+        if (other == cpu) {
+            continue;
+        }
+        while ((int32_t)(qatomic_load_acquire(&oc->pending_ack) - req) < 0 &&
+               qatomic_read(&other->running)) {
+            if (qatomic_read(&c->pending_req) != c->pending_ack) {
+                tlb_drain_pending(cpu);
+            }
+            cpu_relax();
+        }
+    }
+}
+
+void tlb_flush_pending(CPUState *cpu)
+{
+    CPUTLBCommon *c = &cpu->neg.tlb.c;
+
+    assert_cpu_is_self(cpu);
+
+    if (qatomic_read(&c->pending_req) != c->pending_ack) {
+        tlb_drain_pending(cpu);
+    }
+    if (unlikely(qatomic_read(&c->sync_wait))) {
+        tlb_sync_wait(cpu);
+    }
 }
 
 void tlb_flush_range_by_mmuidx(CPUState *cpu, vaddr addr,
@@ -806,8 +931,7 @@ void tlb_flush_range_by_mmuidx_all_cpus_synced(CPUState *src_cpu,
                                                MMUIdxMap idxmap,
                                                unsigned bits)
 {
-    TLBFlushRangeData d, *p;
-    CPUState *dst_cpu;
+    TLBFlushRangeData d;
 
     /* If no page bits are significant, this devolves to tlb_flush. */
     if (bits < TARGET_PAGE_BITS) {
@@ -829,18 +953,7 @@ void tlb_flush_range_by_mmuidx_all_cpus_synced(CPUState *src_cpu,
     d.idxmap = idxmap;
     d.bits = bits;
 
-    /* Allocate a separate data block for each destination cpu.  */
-    CPU_FOREACH(dst_cpu) {
-        if (dst_cpu != src_cpu) {
-            p = g_memdup(&d, sizeof(d));
-            async_run_on_cpu(dst_cpu, tlb_flush_range_by_mmuidx_async_1,
-                             RUN_ON_CPU_HOST_PTR(p));
-        }
-    }
-
-    p = g_memdup(&d, sizeof(d));
-    async_safe_run_on_cpu(src_cpu, tlb_flush_range_by_mmuidx_async_1,
-                          RUN_ON_CPU_HOST_PTR(p));
+    tlb_flush_all_cpus_queue(src_cpu, 0, &d);
 }
 
 void tlb_flush_page_bits_by_mmuidx_all_cpus_synced(CPUState *src_cpu,
@@ -971,13 +1084,11 @@ static void tlb_set_dirty(CPUState *cpu, vaddr addr)
     qemu_spin_unlock(&cpu->neg.tlb.c.lock);
 }
 
-/* Our TLB does not support large pages, so remember the area covered by
-   large pages and trigger a full TLB flush if these are invalidated.  */
-static void tlb_add_large_page(CPUState *cpu, int mmu_idx,
-                               vaddr addr, uint64_t size)
+/* Once a large page is evicted from the large page table, remember the
+   area covered by it and trigger a full TLB flush if it is invalidated.  */
+static void tlb_add_large_region(CPUTLBDesc *desc, vaddr addr, vaddr lp_mask)
 {
-    vaddr lp_addr = cpu->neg.tlb.d[mmu_idx].large_page_addr;
-    vaddr lp_mask = ~(size - 1);
+    vaddr lp_addr = desc->large_page_addr;
 
     if (lp_addr == (vaddr)-1) {
         /* No previous large page.  */
@@ -986,13 +1097,47 @@ static void tlb_add_large_page(CPUState *cpu, int mmu_idx,
         /* Extend the existing region to include the new page.
            This is a compromise between unnecessary flushes and
            the cost of maintaining a full variable size TLB.  */
-        lp_mask &= cpu->neg.tlb.d[mmu_idx].large_page_mask;
+        lp_mask &= desc->large_page_mask;
         while (((lp_addr ^ addr) & lp_mask) != 0) {
             lp_mask <<= 1;
         }
     }
-    cpu->neg.tlb.d[mmu_idx].large_page_addr = lp_addr & lp_mask;
-    cpu->neg.tlb.d[mmu_idx].large_page_mask = lp_mask;
+    desc->large_page_addr = lp_addr & lp_mask;
+    desc->large_page_mask = lp_mask;
+}
+
+/*
+ * Our TLB entries each map a single target page, so remember each
+ * large page that they are filled from, and the translation of the
+ * large page for use by tlb_fill_large.
+ */
+static void tlb_add_large_page(CPUState *cpu, int mmu_idx, vaddr addr,
+                               const CPUTLBEntryFull *full, uint64_t size)
+{
+    CPUTLBDesc *desc = &cpu->neg.tlb.d[mmu_idx];
+    vaddr lp_mask = ~(size - 1);
+    vaddr lp_addr = addr & lp_mask;
+    CPUTLBLargePage *lp = NULL;
+
+    for (int i = 0; i < CPU_LTLB_SIZE; i++) {
+        CPUTLBLargePage *e = &desc->ltable[i];
+
+        if (e->addr == lp_addr && e->mask == lp_mask) {
+            lp = e;
+            break;
+        }
+        if (!lp && e->addr == (vaddr)-1) {
+            lp = e;
+        }
+    }
+    if (!lp) {
+        lp = &desc->ltable[desc->lindex++ % CPU_LTLB_SIZE];
+        tlb_add_large_region(desc, lp->addr, lp->mask);
+    }
+    lp->addr = lp_addr;
+    lp->mask = lp_mask;
+    lp->fill_addr = addr & TARGET_PAGE_MASK;
+    lp->full = *full;
 }
 
 static inline void tlb_set_compare(CPUTLBEntryFull *full, CPUTLBEntry *ent,
@@ -1015,8 +1160,9 @@ static inline void tlb_set_compare(CPUTLBEntryFull *full, CPUTLBEntry *ent,
 
 /*
  * Add a new TLB entry. At most one entry for a given virtual address
- * is permitted. Only a single TARGET_PAGE_SIZE region is mapped, the
- * supplied size is only used by tlb_flush_page.
+ * is permitted. Only a single TARGET_PAGE_SIZE region is mapped; the
+ * supplied size is used by tlb_flush_page, and together with
+ * lg_map_size by tlb_fill_large.
  *
  * Called from TCG-generated code, which is under an RCU read-side
  * critical section.
@@ -1041,7 +1187,7 @@ void tlb_set_page_full(CPUState *cpu, int mmu_idx,
         sz = TARGET_PAGE_SIZE;
     } else {
         sz = (hwaddr)1 << full->lg_page_size;
-        tlb_add_large_page(cpu, mmu_idx, addr, sz);
+        tlb_add_large_page(cpu, mmu_idx, addr, full, sz);
     }
     addr_page = addr & TARGET_PAGE_MASK;
     paddr_page = full->phys_addr & TARGET_PAGE_MASK;
@@ -1229,6 +1375,50 @@ static inline bool tlb_hit(uint64_t tlb_addr, vaddr addr)
     return tlb_hit_page(tlb_addr, addr & TARGET_PAGE_MASK);
 }
 
+/*
+ * Fill the TLB entry for @addr from a large page in the large page
+ * table, without calling into the target.  This requires that the
+ * translation recorded for the large page cover @addr and permit
+ * @type, and that @addr be aligned for @memop whatever the memory
+ * type, so that the target would not have raised an exception.
+ */
+static bool tlb_fill_large(CPUState *cpu, vaddr addr, MMUAccessType type,
+                           int mmu_idx, MemOp memop)
+{
+    CPUTLBDesc *desc = &cpu->neg.tlb.d[mmu_idx];
+    vaddr addr_page = addr & TARGET_PAGE_MASK;
+
+    if (addr & ((1 << memop_tlb_alignment_bits(memop, true)) - 1)) {
+        return false;
+    }
+
+    for (int i = 0; i < CPU_LTLB_SIZE; i++) {
+        CPUTLBLargePage *lp = &desc->ltable[i];
+        CPUTLBEntryFull full;
+        int lg_map_size;
+
+        if (lp->addr == (vaddr)-1) {
+            continue;
+        }
+        lg_map_size = MIN(lp->full.lg_map_size, lp->full.lg_page_size);
+        if (lg_map_size <= TARGET_PAGE_BITS ||
+            (addr_page ^ lp->fill_addr) >> lg_map_size) {
+            continue;
+        }
+        if (!(lp->full.prot & (1 << type)) ||
+            (type == MMU_DATA_STORE && (lp->full.prot & PAGE_WRITE_INV))) {
+            return false;
+        }
+
+        full = lp->full;
+        full.phys_addr = (full.phys_addr & TARGET_PAGE_MASK)
+                       + (addr_page - lp->fill_addr);
+        tlb_set_page_full(cpu, mmu_idx, addr_page, &full);
+        return true;
+    }
+    return false;
+}
+
 /*
  * Note: tlb_fill_align() can trigger a resize of the TLB.
  * This means that all of the caller's prior references to the TLB table
@@ -1242,6 +1432,10 @@ static bool tlb_fill_align(CPUState *cpu, vaddr addr, MMUAccessType type,
     const TCGCPUOps *ops = cpu->cc->tcg_ops;
     CPUTLBEntryFull full;
 
+    if (tlb_fill_large(cpu, addr, type, mmu_idx, memop)) {
+        return true;
+    }
+
     if (ops->tlb_fill_align) {
         if (ops->tlb_fill_align(cpu, &full, addr, type, mmu_idx,
                                 memop, size, probe, ra)) {
@@ -18,6 +18,9 @@ extern int64_t max_delay;
 extern int64_t max_advance;
 
 extern bool one_insn_per_tb;
+extern uint32_t tier_threshold;
+extern uint32_t jmp_cache_size;
+extern uint32_t jmp_cache_ways;
 
 extern bool icount_align_option;
 
@@ -65,6 +68,14 @@ void tlb_init(CPUState *cpu);
  * @cpu: CPU whose TLB should be destroyed
  */
 void tlb_destroy(CPUState *cpu);
+/**
+ * tlb_flush_pending - apply the TLB flushes queued by other CPUs
+ * @cpu: the current CPU
+ *
+ * Called at each cpu_exec loop boundary.  If @cpu itself queued
+ * "synced" flushes, also wait until the other CPUs have applied them.
+ */
+void tlb_flush_pending(CPUState *cpu);
 
 bool tcg_exec_realizefn(CPUState *cpu, Error **errp);
 void tcg_exec_unrealizefn(CPUState *cpu);
@@ -138,6 +149,8 @@ G_NORETURN void cpu_io_recompile(CPUState *cpu, uintptr_t retaddr);
 #endif /* CONFIG_USER_ONLY */
 
 void tb_phys_invalidate(TranslationBlock *tb, tb_page_addr_t page_addr);
+void tb_evict__exclusive_or_serial(void);
+void queue_tb_evict(CPUState *cs);
 void tb_set_jmp_target(TranslationBlock *tb, int n, uintptr_t addr);
 
 void tcg_get_stats(AccelState *accel, GString *buf);
@@ -226,6 +226,104 @@ static void gen_inline_store_u64_cb(struct qemu_plugin_inline_cb *cb)
     tcg_temp_free_ptr(ptr);
 }
 
+static TCGv_ptr gen_record_count_ptr(struct qemu_plugin_record_buffer *buf)
+{
+    qemu_plugin_u64 count = { .score = buf->score,
+                              .offset = offsetof(struct qemu_plugin_record_vcpu,
+                                                 n) };
+
+    return gen_plugin_u64_ptr(count);
+}
+
+/*
+ * Make room for @k records in the buffer of this vcpu, handing its
+ * records to the plugin if it could not take them. This branches, so it
+ * is only emitted at the start of an instruction: doing so where memory
+ * accesses are instrumented would end the extended basic block of temps
+ * that are live across the access.
+ */
+static void gen_record_reserve(struct qemu_plugin_record_buffer *buf, size_t k)
+{
+    static TCGHelperInfo flush_info = {
+        .flags = TCG_CALL_NO_RWG,
+        /* Match qemu_plugin_vcpu_record_flush */
+        .typemask = (dh_typemask(void, 0) |
+                     dh_typemask(i32, 1) |
+                     dh_typemask(ptr, 2))
+    };
+    TCGv_ptr ptr = gen_record_count_ptr(buf);
+    TCGv_i64 n = tcg_temp_ebb_new_i64();
+    TCGLabel *after_flush = gen_new_label();
+
+    assert(k > 0 && k <= buf->size);
+    tcg_gen_ld_i64(n, ptr, 0);
+    tcg_gen_brcondi_i64(TCG_COND_LEU, n, buf->size - k, after_flush);
+    TCGv_i32 cpu_index = gen_cpu_index();
+    tcg_gen_call2(qemu_plugin_vcpu_record_flush, &flush_info, NULL,
+                  tcgv_i32_temp(cpu_index),
+                  tcgv_ptr_temp(tcg_constant_ptr(buf)));
+    tcg_temp_free_i32(cpu_index);
+    gen_set_label(after_flush);
+
+    tcg_temp_free_i64(n);
+    tcg_temp_free_ptr(ptr);
+}
+
+/* Append a record, which gen_record_reserve has made room for. */
+static void gen_record_cb(struct qemu_plugin_record_cb *cb,
+                          qemu_plugin_meminfo_t meminfo, TCGv_i64 addr)
+{
+    TCGv_ptr ptr = gen_record_count_ptr(cb->buf);
+    TCGv_ptr rec = tcg_temp_ebb_new_ptr();
+    TCGv_i64 n = tcg_temp_ebb_new_i64();
+    TCGv_i64 off = tcg_temp_ebb_new_i64();
+
+    tcg_gen_ld_i64(n, ptr, 0);
+    tcg_gen_muli_i64(off, n, sizeof(qemu_plugin_record));
+    tcg_gen_trunc_i64_ptr(rec, off);
+    tcg_gen_add_ptr(rec, rec, ptr);
+    tcg_gen_addi_ptr(rec, rec, offsetof(struct qemu_plugin_record_vcpu,
+                                        records));
+    tcg_gen_st_i64(tcg_constant_i64(cb->data), rec,
+                   offsetof(qemu_plugin_record, data));
+    tcg_gen_st_i64(addr ? addr : tcg_constant_i64(cb->vaddr), rec,
+                   offsetof(qemu_plugin_record, vaddr));
+    tcg_gen_st_i32(tcg_constant_i32(meminfo), rec,
+                   offsetof(qemu_plugin_record, info));
+    tcg_gen_addi_i64(n, n, 1);
+    tcg_gen_st_i64(n, ptr, 0);
+
+    tcg_temp_free_i64(off);
+    tcg_temp_free_i64(n);
+    tcg_temp_free_ptr(rec);
+    tcg_temp_free_ptr(ptr);
+}
+
+/* Append a record out of line, letting qemu_plugin_vcpu_record make room. */
+static void gen_record_call(struct qemu_plugin_record_cb *cb,
+                            qemu_plugin_meminfo_t meminfo, TCGv_i64 addr)
+{
+    static TCGHelperInfo record_info = {
+        .flags = TCG_CALL_NO_RWG,
+        /* Match qemu_plugin_vcpu_record */
+        .typemask = (dh_typemask(void, 0) |
+                     dh_typemask(i32, 1) |
+                     dh_typemask(ptr, 2) |
+                     dh_typemask(i64, 3) |
+                     dh_typemask(i64, 4) |
+                     dh_typemask(i32, 5))
+    };
+    TCGv_i32 cpu_index = gen_cpu_index();
+
+    tcg_gen_call5(qemu_plugin_vcpu_record, &record_info, NULL,
+                  tcgv_i32_temp(cpu_index),
+                  tcgv_ptr_temp(tcg_constant_ptr(cb->buf)),
+                  tcgv_i64_temp(tcg_constant_i64(cb->data)),
+                  tcgv_i64_temp(addr),
+                  tcgv_i32_temp(tcg_constant_i32(meminfo)));
+    tcg_temp_free_i32(cpu_index);
+}
+
 static void gen_mem_cb(struct qemu_plugin_regular_cb *cb,
                        qemu_plugin_meminfo_t meminfo, TCGv_i64 addr)
 {
@@ -264,6 +362,10 @@ static void inject_cb(struct qemu_plugin_dyn_cb *cb)
     case PLUGIN_CB_INLINE_STORE_U64:
         gen_inline_store_u64_cb(&cb->inline_insn);
         break;
+    case PLUGIN_CB_INLINE_RECORD:
+        gen_record_reserve(cb->record.buf, 1);
+        gen_record_cb(&cb->record, 0, NULL);
+        break;
     default:
         g_assert_not_reached();
     }
@@ -271,7 +373,8 @@ static void inject_cb(struct qemu_plugin_dyn_cb *cb)
 
 static void inject_mem_cb(struct qemu_plugin_dyn_cb *cb,
                           enum qemu_plugin_mem_rw rw,
-                          qemu_plugin_meminfo_t meminfo, TCGv_i64 addr)
+                          qemu_plugin_meminfo_t meminfo, TCGv_i64 addr,
+                          bool records_inline)
 {
     switch (cb->type) {
     case PLUGIN_CB_MEM_REGULAR:
@@ -285,15 +388,111 @@ static void inject_mem_cb(struct qemu_plugin_dyn_cb *cb,
             inject_cb(cb);
         }
         break;
+    case PLUGIN_CB_INLINE_RECORD:
+        if (!(rw & cb->record.rw)) {
+            break;
+        }
+        if (records_inline) {
+            gen_record_cb(&cb->record, meminfo, addr);
+        } else {
+            gen_record_call(&cb->record, meminfo, addr);
+        }
+        break;
     default:
         g_assert_not_reached();
     }
 }
 
+/* Is cbs[i] the first record cb of its buffer? */
+static bool record_cb_is_first(const GArray *cbs, int i)
+{
+    const struct qemu_plugin_dyn_cb *cb =
+        &g_array_index(cbs, struct qemu_plugin_dyn_cb, i);
+
+    if (cb->type != PLUGIN_CB_INLINE_RECORD) {
+        return false;
+    }
+    while (--i >= 0) {
+        const struct qemu_plugin_dyn_cb *prev =
+            &g_array_index(cbs, struct qemu_plugin_dyn_cb, i);
+        if (prev->type == PLUGIN_CB_INLINE_RECORD &&
+            prev->record.buf == cb->record.buf) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Count the records appended to @buf by the memory accesses after @op. */
+static size_t mem_record_count(TCGOp *op, const GArray *cbs,
+                               struct qemu_plugin_record_buffer *buf)
+{
+    size_t k = 0;
+
+    for (op = QTAILQ_NEXT(op, link);
+         op && op->opc != INDEX_op_insn_start;
+         op = QTAILQ_NEXT(op, link)) {
+        enum qemu_plugin_mem_rw rw;
+
+        if (op->opc != INDEX_op_plugin_mem_cb) {
+            continue;
+        }
+        rw = (qemu_plugin_mem_is_store(op->args[1])
+              ? QEMU_PLUGIN_MEM_W : QEMU_PLUGIN_MEM_R);
+        for (int i = 0; i < cbs->len; i++) {
+            const struct qemu_plugin_dyn_cb *cb =
+                &g_array_index(cbs, struct qemu_plugin_dyn_cb, i);
+            if (cb->type == PLUGIN_CB_INLINE_RECORD &&
+                cb->record.buf == buf && (rw & cb->record.rw)) {
+                k++;
+            }
+        }
+    }
+    return k;
+}
+
+/*
+ * Called at the start of @insn, whose plugin_cb op is @op. Memory access
+ * records are appended inline only if the insn makes all of its accesses
+ * from generated code, and room for all of them fits in each buffer: it
+ * is then made here, as the accesses themselves cannot branch. Otherwise
+ * they are appended by qemu_plugin_vcpu_record, which makes room itself.
+ */
+static bool gen_mem_record_reserve(TCGOp *op, struct qemu_plugin_insn *insn)
+{
+    const GArray *cbs = insn->mem_cbs;
+    int i, n = (cbs ? cbs->len : 0);
+
+    if (insn->mem_helper) {
+        return false;
+    }
+    for (i = 0; i < n; i++) {
+        if (record_cb_is_first(cbs, i)) {
+            struct qemu_plugin_record_buffer *buf =
+                g_array_index(cbs, struct qemu_plugin_dyn_cb, i).record.buf;
+            if (mem_record_count(op, cbs, buf) > buf->size) {
+                return false;
+            }
+        }
+    }
+    for (i = 0; i < n; i++) {
+        if (record_cb_is_first(cbs, i)) {
+            struct qemu_plugin_record_buffer *buf =
+                g_array_index(cbs, struct qemu_plugin_dyn_cb, i).record.buf;
+            size_t k = mem_record_count(op, cbs, buf);
+            if (k) {
+                gen_record_reserve(buf, k);
+            }
+        }
+    }
+    return true;
+}
+
 static void plugin_gen_inject(struct qemu_plugin_tb *plugin_tb)
 {
     TCGOp *op, *next;
     int insn_idx = -1;
+    bool mem_records_inline = true;
 
     if (unlikely(qemu_loglevel_mask(LOG_TB_OP_PLUGIN)
                  && qemu_log_in_addr_range(tcg_ctx->plugin_db->pc_first))) {
@@ -366,6 +565,7 @@ static void plugin_gen_inject(struct qemu_plugin_tb *plugin_tb)
                     inject_cb(
                         &g_array_index(cbs, struct qemu_plugin_dyn_cb, i));
                 }
+                mem_records_inline = gen_mem_record_reserve(op, insn);
                 break;
 
             default:
@@ -396,7 +596,7 @@ static void plugin_gen_inject(struct qemu_plugin_tb *plugin_tb)
             cbs = insn->mem_cbs;
             for (i = 0, n = (cbs ? cbs->len : 0); i < n; i++) {
                 inject_mem_cb(&g_array_index(cbs, struct qemu_plugin_dyn_cb, i),
-                              rw, meminfo, addr);
+                              rw, meminfo, addr, mem_records_inline);
             }
 
             tcg_ctx->emit_before_op = NULL;
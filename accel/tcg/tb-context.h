@@ -34,7 +34,9 @@ struct TBContext {
 
     /* statistics */
     unsigned tb_flush_count;
+    unsigned tb_evict_count;
     unsigned tb_phys_invalidate_count;
+    unsigned tb_tier_up_count;
 };
 
 extern TBContext tb_ctx;
@@ -11,23 +11,57 @@
 
 #include "qemu/rcu.h"
 #include "exec/cpu-common.h"
+#include "hw/core/cpu.h"
 
+/* Default geometry; see the jmp-cache-size and jmp-cache-ways properties */
 #define TB_JMP_CACHE_BITS 12
 #define TB_JMP_CACHE_SIZE (1 << TB_JMP_CACHE_BITS)
 
+#define TB_JMP_CACHE_MIN_BITS  6
+#define TB_JMP_CACHE_MAX_BITS  16
+#define TB_JMP_CACHE_MAX_WAYS  4
+
 /*
+ * The cache has 1 << @bits sets of @ways entries each; a set is the
+ * @ways consecutive entries starting at array[set * ways], most recently
+ * used first.
+ *
  * Invalidated in parallel; all accesses to 'tb' must be atomic.
  * A valid entry is read/written by a single CPU, therefore there is
  * no need for qatomic_rcu_read() and pc is always consistent with a
  * non-NULL value of 'tb'.  Strictly speaking pc is only needed for
- * CF_PCREL, but it's used always for simplicity.
+ * CF_PCREL, but it's used always for simplicity.  An entry may move
+ * within its set while being invalidated; a stale TB left behind is
+ * harmless, as CF_INVALID prevents it from matching.
+ *
+ * The statistics are written only by the owning CPU.
  */
 typedef struct CPUJumpCache {
     struct rcu_head rcu;
+    unsigned int bits;
+    unsigned int ways;
+    uint64_t hits;         /* found in the jump cache */
+    uint64_t htable_hits;  /* missed, then found in the QHT */
+    uint64_t misses;       /* missed in both: needs translation */
+    uint64_t ic_misses;    /* of the above, from an inline cache miss */
     struct {
         TranslationBlock *tb;
         vaddr pc;
-    } array[TB_JMP_CACHE_SIZE];
+    } array[];
 } CPUJumpCache;
 
+static inline size_t tb_jmp_cache_entries(const CPUJumpCache *jc)
+{
+    return (size_t)jc->ways << jc->bits;
+}
+
+/*
+ * Drop the return address stack of @cpu, which points to the TBs of the
+ * calls.  Called when TBs are reclaimed, while no vCPU runs.
+ */
+static inline void tb_ras_flush(CPUState *cpu)
+{
+    memset(cpu->tb_ras_tb, 0, sizeof(cpu->tb_ras_tb));
+}
+
 #endif /* ACCEL_TCG_TB_JMP_CACHE_H */
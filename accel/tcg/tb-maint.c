@@ -190,6 +190,12 @@ struct PageDesc {
     QemuSpin lock;
     /* list of TBs intersecting this ram page */
     uintptr_t first_tb;
+    /*
+     * Bit i is set if a TB may cover the i'th 1/64th of the page.
+     * Bits are set under @lock when a TB is added, but only cleared
+     * when the page is next invalidated; read without the lock.
+     */
+    uint64_t code_bitmap;
 };
 
 void page_table_config_init(void)
@@ -272,6 +278,43 @@ static inline PageDesc *page_find(tb_page_addr_t index)
     return page_find_alloc(index, false);
 }
 
+#define CODE_BITMAP_SHIFT  (TARGET_PAGE_BITS - 6)
+
+static uint64_t code_bitmap_range(tb_page_addr_t start, tb_page_addr_t last)
+{
+    unsigned b0 = (start & ~TARGET_PAGE_MASK) >> CODE_BITMAP_SHIFT;
+    unsigned b1 = (last & ~TARGET_PAGE_MASK) >> CODE_BITMAP_SHIFT;
+
+    return MAKE_64BIT_MASK(b0, b1 - b0 + 1);
+}
+
+/* Return the bytes [*@start, *@last] of @tb that lie on its page @n. */
+static void tb_page_range(const TranslationBlock *tb, unsigned n,
+                          tb_page_addr_t *start, tb_page_addr_t *last)
+{
+    tb_page_addr_t tb_start, tb_last;
+
+    /* NOTE: this is subtle as a TB may span two physical pages */
+    tb_start = tb_page_addr0(tb);
+    tb_last = tb_start + tb->size - 1;
+    if (n == 0) {
+        tb_last = MIN(tb_last, tb_start | ~TARGET_PAGE_MASK);
+    } else {
+        tb_start = tb_page_addr1(tb);
+        tb_last = tb_start + (tb_last & ~TARGET_PAGE_MASK);
+    }
+    *start = tb_start;
+    *last = tb_last;
+}
+
+static uint64_t tb_page_code_bits(const TranslationBlock *tb, unsigned n)
+{
+    tb_page_addr_t start, last;
+
+    tb_page_range(tb, n, &start, &last);
+    return code_bitmap_range(start, last);
+}
+
 /**
  * struct page_entry - page descriptor entry
  * @pd:     pointer to the &struct PageDesc of the page this entry represents
@@ -671,6 +714,7 @@ static void tb_remove_all_1(int level, void **lp)
         for (i = 0; i < V_L2_SIZE; ++i) {
             page_lock(&pd[i]);
             pd[i].first_tb = (uintptr_t)NULL;
+            qatomic_set(&pd[i].code_bitmap, 0);
             page_unlock(&pd[i]);
         }
     } else {
@@ -704,6 +748,7 @@ static void tb_page_add(PageDesc *p, TranslationBlock *tb, unsigned int n)
     tb->page_next[n] = p->first_tb;
     page_already_protected = p->first_tb != 0;
     p->first_tb = (uintptr_t)tb | n;
+    qatomic_set(&p->code_bitmap, p->code_bitmap | tb_page_code_bits(tb, n));
 
     /*
      * If some code is already present, then the pages are already
@@ -779,6 +824,7 @@ void tb_flush__exclusive_or_serial(void)
 
     CPU_FOREACH(cpu) {
         tcg_flush_jmp_cache(cpu);
+        tb_ras_flush(cpu);
     }
 
     qht_reset_size(&tb_ctx.htable, CODE_GEN_HTABLE_SIZE);
@@ -901,13 +947,14 @@ static void tb_jmp_cache_inval_tb(TranslationBlock *tb)
             tcg_flush_jmp_cache(cpu);
         }
     } else {
-        uint32_t h = tb_jmp_cache_hash_func(tb->pc);
-
         CPU_FOREACH(cpu) {
             CPUJumpCache *jc = cpu->tb_jmp_cache;
+            unsigned int set = tb_jmp_cache_hash_func(jc, tb->pc) * jc->ways;
 
-            if (qatomic_read(&jc->array[h].tb) == tb) {
-                qatomic_set(&jc->array[h].tb, NULL);
+            for (unsigned int way = 0; way < jc->ways; way++) {
+                if (qatomic_read(&jc->array[set + way].tb) == tb) {
+                    qatomic_set(&jc->array[set + way].tb, NULL);
+                }
             }
         }
     }
@@ -975,6 +1022,70 @@ void tb_phys_invalidate(TranslationBlock *tb, tb_page_addr_t page_addr)
     }
 }
 
+static void tb_evict(TranslationBlock *tb)
+{
+    /* One-shot TBs are never linked; the jump caches are flushed below. */
+    if (tb_page_addr0(tb) != -1) {
+        tb_phys_invalidate(tb, -1);
+    }
+}
+
+/*
+ * Make room in the code generation buffer by evicting the oldest region,
+ * rather than every TB.  Falls back to tb_flush__exclusive_or_serial()
+ * if there is no region to evict, e.g. every region is in use by a vCPU.
+ * Same calling context as tb_flush__exclusive_or_serial().
+ */
+void tb_evict__exclusive_or_serial(void)
+{
+    bool evicted;
+
+    assert(tcg_enabled());
+    assert(!runstate_is_running() ||
+           (current_cpu && cpu_in_serial_context(current_cpu)));
+
+    mmap_lock();
+    evicted = tcg_region_evict(tb_evict);
+    mmap_unlock();
+
+    if (evicted) {
+        CPUState *cpu;
+
+        /*
+         * A lookup racing with tb_phys_invalidate may have left an
+         * invalid TB in a jump cache.  That is harmless while the TB
+         * memory stays, but the region is about to be reused.  The
+         * same goes for the return address stacks, and for the inline
+         * caches of the TBs that remain, which are tagged with
+         * tb_evict_count.
+         */
+        CPU_FOREACH(cpu) {
+            tcg_flush_jmp_cache(cpu);
+            tb_ras_flush(cpu);
+        }
+        trace_tb_evict();
+        qatomic_inc(&tb_ctx.tb_evict_count);
+    } else {
+        tb_flush__exclusive_or_serial();
+    }
+}
+
+static void do_tb_evict(CPUState *cpu, run_on_cpu_data tb_evict_count)
+{
+    /* A region freed on request of another CPU may satisfy us; retry. */
+    if (tb_ctx.tb_evict_count == tb_evict_count.host_int) {
+        tb_evict__exclusive_or_serial();
+    }
+}
+
+void queue_tb_evict(CPUState *cs)
+{
+    unsigned tb_evict_count = qatomic_read(&tb_ctx.tb_evict_count);
+
+    async_safe_run_on_cpu(cs, do_tb_evict,
+                          RUN_ON_CPU_HOST_INT(tb_evict_count));
+}
+
 /*
  * Add a new TB and link it to the physical page tables.
  * Called with mmap_lock held for user-mode emulation.
@@ -1114,6 +1225,7 @@ tb_invalidate_phys_page_range__locked(CPUState *cpu,
     PageForEachNext n;
     bool current_tb_modified = false;
     TranslationBlock *current_tb = NULL;
+    uint64_t code_bits = 0;
 
     /* Range may not cross a page. */
     tcg_debug_assert(((start ^ last) & TARGET_PAGE_MASK) == 0);
@@ -1129,16 +1241,10 @@ tb_invalidate_phys_page_range__locked(CPUState *cpu,
     PAGE_FOR_EACH_TB(start, last, p, tb, n) {
         tb_page_addr_t tb_start, tb_last;
 
-        /* NOTE: this is subtle as a TB may span two physical pages */
-        tb_start = tb_page_addr0(tb);
-        tb_last = tb_start + tb->size - 1;
-        if (n == 0) {
-            tb_last = MIN(tb_last, tb_start | ~TARGET_PAGE_MASK);
+        tb_page_range(tb, n, &tb_start, &tb_last);
+        if (tb_last < start || tb_start > last) {
+            code_bits |= code_bitmap_range(tb_start, tb_last);
         } else {
-            tb_start = tb_page_addr1(tb);
-            tb_last = tb_start + (tb_last & ~TARGET_PAGE_MASK);
-        }
-        if (!(tb_last < start || tb_start > last)) {
             if (unlikely(current_tb == tb) &&
                 (tb_cflags(current_tb) & CF_COUNT_MASK) != 1) {
                 /*
@@ -1155,6 +1261,12 @@ tb_invalidate_phys_page_range__locked(CPUState *cpu,
         }
     }
 
+    /*
+     * The TBs that remain are exactly those not overlapping the write;
+     * drop the bits of the invalidated (or earlier removed) ones.
+     */
+    qatomic_set(&p->code_bitmap, code_bits);
+
     /* if no code remaining, no need to continue to use slow writes */
     if (!p->first_tb) {
         tlb_unprotect_code(start);
@@ -1205,6 +1317,12 @@ void tb_invalidate_phys_range(CPUState *cpu, tb_page_addr_t start,
  * len must be <= 8 and start must be a multiple of len.
  * Called via softmmu_template.h when code areas are written to with
  * iothread mutex not held.
+ *
+ * Writes that miss every TB on a page holding code, e.g. to data
+ * sharing a page with a JIT's code, or to a patch site whose TBs were
+ * already invalidated, return without taking any lock.  PageDescs are
+ * never freed, so the bitmap may be read at any time.  As before, a TB
+ * translated concurrently with the write may see either value.
  */
 void tb_invalidate_phys_range_fast(CPUState *cpu, ram_addr_t start,
                                    unsigned len, uintptr_t ra)
@@ -1213,7 +1331,18 @@ void tb_invalidate_phys_range_fast(CPUState *cpu, ram_addr_t start,
 
     if (p) {
         ram_addr_t last = start + len - 1;
-        struct page_collection *pages = page_collection_lock(start, last);
+        uint64_t code_bits = qatomic_read(&p->code_bitmap);
+        struct page_collection *pages;
+
+        /*
+         * With an empty bitmap, take the locked path once so that the
+         * page is unprotected when no code remains.
+         */
+        if (code_bits && !(code_bits & code_bitmap_range(start, last))) {
+            return;
+        }
+
+        pages = page_collection_lock(start, last);
 
         tb_invalidate_phys_page_range__locked(cpu, pages, p,
                                               start, last, ra);
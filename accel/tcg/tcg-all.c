@@ -45,6 +45,7 @@
 #include "accel/accel-cpu-ops.h"
 #include "accel/tcg/cpu-ops.h"
 #include "internal-common.h"
+#include "tb-jmp-cache.h"
 
 
 struct TCGState {
@@ -52,6 +53,9 @@ struct TCGState {
 
     OnOffAuto mttcg_enabled;
     bool one_insn_per_tb;
+    uint32_t tier_threshold;
+    uint32_t jmp_cache_size;
+    uint32_t jmp_cache_ways;
     int splitwx_enabled;
     unsigned long tb_size;
 };
@@ -80,9 +84,14 @@ static void tcg_accel_instance_init(Object *obj)
 #else
     s->splitwx_enabled = 0;
 #endif
+    s->jmp_cache_size = TB_JMP_CACHE_SIZE;
+    s->jmp_cache_ways = 1;
 }
 
 bool one_insn_per_tb;
+uint32_t tier_threshold;
+uint32_t jmp_cache_size = TB_JMP_CACHE_SIZE;
+uint32_t jmp_cache_ways = 1;
 
 #ifndef CONFIG_USER_ONLY
 static void tcg_vm_change_state(void *opaque, bool running, RunState state)
@@ -242,6 +251,96 @@ static void tcg_set_one_insn_per_tb(Object *obj, bool value, Error **errp)
     qatomic_set(&one_insn_per_tb, value);
 }
 
+static void tcg_get_tier_threshold(Object *obj, Visitor *v,
+                                   const char *name, void *opaque,
+                                   Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    uint32_t value = s->tier_threshold;
+
+    visit_type_uint32(v, name, &value, errp);
+}
+
+static void tcg_set_tier_threshold(Object *obj, Visitor *v,
+                                   const char *name, void *opaque,
+                                   Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    uint32_t value;
+
+    if (!visit_type_uint32(v, name, &value, errp)) {
+        return;
+    }
+
+    s->tier_threshold = value;
+    /* Set the global also: TBs translated from now on use it */
+    qatomic_set(&tier_threshold, value);
+}
+
+static void tcg_get_jmp_cache_size(Object *obj, Visitor *v,
+                                   const char *name, void *opaque,
+                                   Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    uint32_t value = s->jmp_cache_size;
+
+    visit_type_uint32(v, name, &value, errp);
+}
+
+static void tcg_set_jmp_cache_size(Object *obj, Visitor *v,
+                                   const char *name, void *opaque,
+                                   Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    uint32_t value;
+
+    if (!visit_type_uint32(v, name, &value, errp)) {
+        return;
+    }
+    if (!is_power_of_2(value) ||
+        value < (1u << TB_JMP_CACHE_MIN_BITS) ||
+        value > (1u << TB_JMP_CACHE_MAX_BITS)) {
+        error_setg(errp, "jmp-cache-size must be a power of 2 between "
+                   "%u and %u", 1u << TB_JMP_CACHE_MIN_BITS,
+                   1u << TB_JMP_CACHE_MAX_BITS);
+        return;
+    }
+
+    s->jmp_cache_size = value;
+    /* Set the global also: vCPUs realized from now on use it */
+    jmp_cache_size = value;
+}
+
+static void tcg_get_jmp_cache_ways(Object *obj, Visitor *v,
+                                   const char *name, void *opaque,
+                                   Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    uint32_t value = s->jmp_cache_ways;
+
+    visit_type_uint32(v, name, &value, errp);
+}
+
+static void tcg_set_jmp_cache_ways(Object *obj, Visitor *v,
+                                   const char *name, void *opaque,
+                                   Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    uint32_t value;
+
+    if (!visit_type_uint32(v, name, &value, errp)) {
+        return;
+    }
+    if (!is_power_of_2(value) || value > TB_JMP_CACHE_MAX_WAYS) {
+        error_setg(errp, "jmp-cache-ways must be 1, 2 or 4");
+        return;
+    }
+
+    s->jmp_cache_ways = value;
+    /* Set the global also: vCPUs realized from now on use it */
+    jmp_cache_ways = value;
+}
+
 static int tcg_gdbstub_supported_sstep_flags(AccelState *as)
 {
     /*
@@ -288,6 +387,25 @@ static void tcg_accel_class_init(ObjectClass *oc, const void *data)
                                    tcg_set_one_insn_per_tb);
     object_class_property_set_description(oc, "one-insn-per-tb",
         "Only put one guest insn in each translation block");
+
+    object_class_property_add(oc, "tier-threshold", "uint32",
+        tcg_get_tier_threshold, tcg_set_tier_threshold,
+        NULL, NULL);
+    object_class_property_set_description(oc, "tier-threshold",
+        "Retranslate a translation block as a trace after this many "
+        "executions (0 = off)");
+
+    object_class_property_add(oc, "jmp-cache-size", "uint32",
+        tcg_get_jmp_cache_size, tcg_set_jmp_cache_size,
+        NULL, NULL);
+    object_class_property_set_description(oc, "jmp-cache-size",
+        "Number of entries in the per-vCPU translation block jump cache");
+
+    object_class_property_add(oc, "jmp-cache-ways", "uint32",
+        tcg_get_jmp_cache_ways, tcg_set_jmp_cache_ways,
+        NULL, NULL);
+    object_class_property_set_description(oc, "jmp-cache-ways",
+        "Associativity of the per-vCPU translation block jump cache");
 }
 
 static const TypeInfo tcg_accel_type = {
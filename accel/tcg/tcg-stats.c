@@ -16,6 +16,8 @@
 #include "tcg/tcg.h"
 #include "internal-common.h"
 #include "tb-context.h"
+#include "tb-jmp-cache.h"
+#include "tb-hash.h"
 #include <math.h>
 
 static void dump_drift_info(GString *buf)
@@ -44,8 +46,12 @@ static void dump_accel_info(AccelState *accel, GString *buf)
                                                     &error_fatal);
 
     g_string_append_printf(buf, "Accelerator settings:\n");
-    g_string_append_printf(buf, "one-insn-per-tb: %s\n\n",
+    g_string_append_printf(buf, "one-insn-per-tb: %s\n",
                            one_insn_per_tb ? "on" : "off");
+    g_string_append_printf(buf, "tier-threshold: %u\n",
+                           qatomic_read(&tier_threshold));
+    g_string_append_printf(buf, "jmp-cache: %u entries, %u-way\n\n",
+                           jmp_cache_size, jmp_cache_ways);
 }
 
 static void print_qht_statistics(struct qht_stats hst, GString *buf)
@@ -147,14 +153,33 @@ static void tlb_flush_counts(size_t *pfull, size_t *ppart, size_t *pelide)
     *pelide = elide;
 }
 
+static void tcg_dump_evict_info(GString *buf)
+{
+    size_t i, n = tcg_nb_regions();
+
+    g_string_append_printf(buf, "TB evict count      %u\n",
+                           qatomic_read(&tb_ctx.tb_evict_count));
+    if (!qatomic_read(&tb_ctx.tb_evict_count)) {
+        return;
+    }
+    g_string_append_printf(buf, "  per region       ");
+    for (i = 0; i < n; i++) {
+        g_string_append_printf(buf, " %zu", tcg_region_evictions(i));
+    }
+    g_string_append_c(buf, '\n');
+}
+
 static void tcg_dump_flush_info(GString *buf)
 {
     size_t flush_full, flush_part, flush_elide;
 
     g_string_append_printf(buf, "TB flush count      %u\n",
                            qatomic_read(&tb_ctx.tb_flush_count));
+    tcg_dump_evict_info(buf);
     g_string_append_printf(buf, "TB invalidate count %u\n",
                            qatomic_read(&tb_ctx.tb_phys_invalidate_count));
+    g_string_append_printf(buf, "TB tier-up count    %u\n",
+                           qatomic_read(&tb_ctx.tb_tier_up_count));
 
     tlb_flush_counts(&flush_full, &flush_part, &flush_elide);
     g_string_append_printf(buf, "TLB full flushes    %zu\n", flush_full);
@@ -162,6 +187,68 @@ static void tcg_dump_flush_info(GString *buf)
     g_string_append_printf(buf, "TLB elided flushes  %zu\n", flush_elide);
 }
 
+static void dump_jmp_cache_info(GString *buf)
+{
+    uint64_t hits = 0, htable_hits = 0, misses = 0, ic_misses = 0, total;
+    CPUState *cpu;
+
+    CPU_FOREACH(cpu) {
+        CPUJumpCache *jc = cpu->tb_jmp_cache;
+
+        if (!jc) {
+            continue;
+        }
+        hits += qatomic_read(&jc->hits);
+        htable_hits += qatomic_read(&jc->htable_hits);
+        misses += qatomic_read(&jc->misses);
+        ic_misses += qatomic_read(&jc->ic_misses);
+    }
+    total = hits + htable_hits + misses;
+
+    g_string_append_printf(buf, "TB lookups          %" PRIu64 "\n", total);
+    g_string_append_printf(buf, "  jmp cache hits    %" PRIu64 " (%0.2f%%)\n",
+                           hits, total ? (double)hits / total * 100 : 0);
+    g_string_append_printf(buf, "  QHT hits          %" PRIu64 " (%0.2f%%)\n",
+                           htable_hits,
+                           total ? (double)htable_hits / total * 100 : 0);
+    g_string_append_printf(buf, "  misses            %" PRIu64 " (%0.2f%%)\n",
+                           misses, total ? (double)misses / total * 100 : 0);
+    g_string_append_printf(buf, "  from inline cache %" PRIu64 "\n", ic_misses);
+}
+
+static void dump_opt_info(GString *buf)
+{
+    TCGOptStats st;
+
+    tcg_get_opt_stats(&st);
+    if (!st.ops_in) {
+        return;
+    }
+    g_string_append_printf(buf, "Optimizer ops       %" PRIu64 " -> %" PRIu64
+                           " (%0.2f%% removed)\n", st.ops_in, st.ops_out,
+                           ((double)st.ops_in - st.ops_out) / st.ops_in * 100);
+    g_string_append_printf(buf, "  loads forwarded   %" PRIu64 "\n", st.ld_fwd);
+    g_string_append_printf(buf, "  common subexprs   %" PRIu64 "\n", st.cse);
+    g_string_append_printf(buf, "  dead stores       %" PRIu64 "\n",
+                           st.dead_st);
+}
+
+static void dump_gen_time_info(GString *buf)
+{
+    CPUState *cpu;
+
+    g_string_append_printf(buf, "\nTranslation stalls:\n");
+    CPU_FOREACH(cpu) {
+        uint64_t count = qatomic_read(&cpu->tb_gen_count);
+        uint64_t ns = qatomic_read(&cpu->tb_gen_ns);
+
+        g_string_append_printf(buf, "CPU %-3d             %" PRIu64 " TBs, "
+                               "%" PRIu64 " ms (avg %" PRIu64 " us)\n",
+                               cpu->cpu_index, count, ns / SCALE_MS,
+                               count ? ns / count / SCALE_US : 0);
+    }
+}
+
 static void dump_exec_info(GString *buf)
 {
     struct tb_tree_stats tst = {};
@@ -204,6 +291,10 @@ static void dump_exec_info(GString *buf)
 
     g_string_append_printf(buf, "\nStatistics:\n");
     tcg_dump_flush_info(buf);
+    dump_jmp_cache_info(buf);
+    dump_opt_info(buf);
+
+    dump_gen_time_info(buf);
 }
 
 void tcg_get_stats(AccelState *accel, GString *buf)
@@ -217,3 +308,86 @@ void tcg_dump_stats(GString *buf)
 {
     tcg_get_stats(current_accel(), buf);
 }
+
+#define HOT_TBS 32
+
+struct tb_hotness {
+    const TranslationBlock *tbs[HOT_TBS];
+    uint32_t counts[HOT_TBS];
+    size_t nb_tbs;
+};
+
+/* TBs hashed to the same counters share them, so this is an estimate */
+static uint32_t tb_exec_count_sum(const TranslationBlock *tb)
+{
+    unsigned int slot = tb_exec_count_slot(tb);
+    uint32_t count = 0;
+    CPUState *cpu;
+
+    CPU_FOREACH(cpu) {
+        if (cpu->tb_exec_count) {
+            count += qatomic_read(&cpu->tb_exec_count[slot]);
+        }
+    }
+    return count;
+}
+
+static gboolean tb_hotness_iter(gpointer key, gpointer value, gpointer data)
+{
+    const TranslationBlock *tb = value;
+    struct tb_hotness *th = data;
+    uint32_t count = tb_exec_count_sum(tb);
+    size_t i;
+
+    if (tb_cflags(tb) & CF_INVALID) {
+        return false;
+    }
+    if (!count && !tb->trace) {
+        return false;
+    }
+
+    /* Insertion sort into the table, hottest first. */
+    for (i = th->nb_tbs; i > 0 && th->counts[i - 1] < count; i--) {
+        if (i < HOT_TBS) {
+            th->tbs[i] = th->tbs[i - 1];
+            th->counts[i] = th->counts[i - 1];
+        }
+    }
+    if (i < HOT_TBS) {
+        th->tbs[i] = tb;
+        th->counts[i] = count;
+        th->nb_tbs = MIN(th->nb_tbs + 1, HOT_TBS);
+    }
+    return false;
+}
+
+void tcg_dump_hotness(GString *buf)
+{
+    struct tb_hotness th = {};
+    size_t i;
+
+    if (!qatomic_read(&tier_threshold)) {
+        g_string_append_printf(buf, "Execution counting is disabled, "
+                               "use -accel tcg,tier-threshold=N\n");
+        return;
+    }
+
+    tcg_tb_foreach(tb_hotness_iter, &th);
+
+    g_string_append_printf(buf, "Hottest TBs (threshold %u, %u tier-ups):\n",
+                           qatomic_read(&tier_threshold),
+                           qatomic_read(&tb_ctx.tb_tier_up_count));
+    for (i = 0; i < th.nb_tbs; i++) {
+        const TranslationBlock *tb = th.tbs[i];
+
+        if (tb_cflags(tb) & CF_PCREL) {
+            g_string_append_printf(buf, "  phys 0x%" PRIx64,
+                                   (uint64_t)tb_page_addr0(tb));
+        } else {
+            g_string_append_printf(buf, "  pc   0x%" VADDR_PRIx, tb->pc);
+        }
+        g_string_append_printf(buf, "  size %-5u exec %-10u%s\n",
+                               tb->size, th.counts[i],
+                               tb->trace ? " trace" : "");
+    }
+}
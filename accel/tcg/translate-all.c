@@ -288,15 +288,15 @@ TranslationBlock *tb_gen_code(CPUState *cpu, TCGTBCPUState s)
     assert_no_pages_locked();
     tb = tcg_tb_alloc(tcg_ctx);
     if (unlikely(!tb)) {
-        /* flush must be done */
+        /* eviction must be done */
         if (cpu_in_serial_context(cpu)) {
             trace_tb_gen_code_buffer_overflow("tcg_tb_alloc");
-            tb_flush__exclusive_or_serial();
+            tb_evict__exclusive_or_serial();
             goto buffer_overflow;
         }
-        queue_tb_flush(cpu);
+        queue_tb_evict(cpu);
         mmap_unlock();
-        /* Make the execution loop process the flush as soon as possible.  */
+        /* Make the execution loop process the eviction as soon as possible. */
         cpu->exception_index = EXCP_INTERRUPT;
         cpu_loop_exit(cpu);
     }
@@ -309,6 +309,11 @@ TranslationBlock *tb_gen_code(CPUState *cpu, TCGTBCPUState s)
     tb->cs_base = s.cs_base;
     tb->flags = s.flags;
     tb->cflags = s.cflags;
+    tb->trace = false;
+    for (int i = 0; i < TB_IC_NB; i++) {
+        tb->ic[i].gen = tb_ctx.tb_evict_count;
+        memset(tb->ic[i].tb, 0, sizeof(tb->ic[i].tb));
+    }
     tb_set_page_addr0(tb, phys_pc);
     tb_set_page_addr1(tb, -1);
     if (phys_pc != -1) {
@@ -479,6 +484,15 @@ TranslationBlock *tb_gen_code(CPUState *cpu, TCGTBCPUState s)
         ROUND_UP((uintptr_t)gen_code_buf + gen_code_size + search_size,
                  CODE_GEN_ALIGN));
 
+    /*
+     * A trace replaces the tier-0 TB dropped by helper_tb_tier_up; clear
+     * CF_TRACE so that the normal lookups find it.
+     */
+    if (tb->cflags & CF_TRACE) {
+        tb->cflags &= ~CF_TRACE;
+        tb->trace = true;
+    }
+
     /* init jump list */
     qemu_spin_init(&tb->jmp_lock);
     tb->jmp_list_head = (uintptr_t)NULL;
@@ -633,7 +647,7 @@ void tcg_flush_jmp_cache(CPUState *cpu)
         return;
     }
 
-    for (int i = 0; i < TB_JMP_CACHE_SIZE; i++) {
+    for (size_t i = 0, n = tb_jmp_cache_entries(jc); i < n; i++) {
         qatomic_set(&jc->array[i].tb, NULL);
     }
 }
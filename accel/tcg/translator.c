@@ -20,6 +20,8 @@
 #include "internal-common.h"
 #include "disas/disas.h"
 #include "tb-internal.h"
+#include "tb-hash.h"
+#include "tb-context.h"
 
 static void set_can_do_io(DisasContextBase *db, bool val)
 {
@@ -40,7 +42,21 @@ bool translator_io_start(DisasContextBase *db)
     return true;
 }
 
-static TCGOp *gen_tb_start(DisasContextBase *db, uint32_t cflags)
+/*
+ * Count executions of tier-0 TBs.  Traces, and TBs that are one-off
+ * or cannot exit early, are not retranslated.  Neither are TBs under
+ * icount: a trace is charged for all of its insns on entry, even when
+ * it leaves early through a side exit.
+ */
+static bool tb_counts_executions(uint32_t cflags)
+{
+    return qatomic_read(&tier_threshold) &&
+           !(cflags & (CF_TRACE | CF_NOIRQ | CF_COUNT_MASK | CF_USE_ICOUNT |
+                       CF_SINGLE_STEP | CF_BP_PAGE | CF_NO_GOTO_TB));
+}
+
+static TCGOp *gen_tb_start(DisasContextBase *db, uint32_t cflags,
+                           TCGLabel **tier_label)
 {
     TCGv_i32 count = NULL;
     TCGOp *icount_start_insn = NULL;
@@ -76,6 +92,27 @@ static TCGOp *gen_tb_start(DisasContextBase *db, uint32_t cflags)
         tcg_gen_brcondi_i32(TCG_COND_LT, count, 0, tcg_ctx->exitreq_label);
     }
 
+    /*
+     * Bump the execution count, kept per vCPU outside of the code buffer;
+     * on reaching the threshold, leave before the icount budget is
+     * consumed so the trace can run in our place.
+     */
+    *tier_label = NULL;
+    if (tb_counts_executions(cflags)) {
+        intptr_t ofs = tb_exec_count_slot(db->tb) * sizeof(uint32_t);
+        TCGv_ptr counts = tcg_temp_new_ptr();
+        TCGv_i32 n = tcg_temp_new_i32();
+
+        tcg_gen_ld_ptr(counts, tcg_env,
+                       offsetof(CPUState, tb_exec_count) - sizeof(CPUState));
+        tcg_gen_ld_i32(n, counts, ofs);
+        tcg_gen_addi_i32(n, n, 1);
+        tcg_gen_st_i32(n, counts, ofs);
+        *tier_label = gen_new_label();
+        tcg_gen_brcondi_i32(TCG_COND_GEU, n, qatomic_read(&tier_threshold),
+                            *tier_label);
+    }
+
     if (cflags & CF_USE_ICOUNT) {
         tcg_gen_st16_i32(count, tcg_env,
                          offsetof(CPUState, neg.icount_decr.u16.low) -
@@ -86,8 +123,15 @@ static TCGOp *gen_tb_start(DisasContextBase *db, uint32_t cflags)
 }
 
 static void gen_tb_end(const TranslationBlock *tb, uint32_t cflags,
-                       TCGOp *icount_start_insn, int num_insns)
+                       TCGOp *icount_start_insn, TCGLabel *tier_label,
+                       int num_insns)
 {
+    if (tier_label) {
+        gen_set_label(tier_label);
+        gen_helper_tb_tier_up(tcg_env, tcg_constant_ptr(tb));
+        tcg_gen_exit_tb(tb, TB_EXIT_REQUESTED);
+    }
+
     if (cflags & CF_USE_ICOUNT) {
         /*
          * Update the num_insn immediate parameter now that we know
@@ -119,6 +163,226 @@ bool translator_use_goto_tb(DisasContextBase *db, vaddr dest)
     return translator_is_same_page(db, dest);
 }
 
+bool translator_follow_jump(DisasContextBase *db, vaddr dest)
+{
+    /*
+     * Each of these wants the TB to end at the jump: either exits
+     * must be observable, or plugins expect one linear run of insns.
+     * Under icount, the whole TB is charged on entry, which would be
+     * wrong for the side exits of translator_follow_branch.
+     */
+    if (tb_cflags(db->tb) & (CF_NO_GOTO_TB | CF_SINGLE_STEP | CF_BP_PAGE |
+                             CF_USE_ICOUNT)) {
+        return false;
+    }
+    if (db->plugin_enabled) {
+        return false;
+    }
+    /* With tiered translation, only traces extend past jumps. */
+    if (qatomic_read(&tier_threshold) && !translator_is_trace(db)) {
+        return false;
+    }
+
+    /*
+     * Only follow forward jumps on the first page.  The TB then still
+     * covers [pc_first, pc_next), a superset of the bytes translated,
+     * so that invalidation on writes to the skipped bytes is merely
+     * conservative.  Forward-only also bounds the region by the page.
+     */
+    if (dest <= db->pc_next || !translator_is_same_page(db, dest)) {
+        return false;
+    }
+    return db->num_insns < db->max_insns;
+}
+
+bool translator_is_trace(const DisasContextBase *db)
+{
+    return tb_cflags(db->tb) & CF_TRACE;
+}
+
+bool translator_follow_branch(DisasContextBase *db, vaddr taken,
+                              vaddr fallthrough)
+{
+    /*
+     * Without a profile, predict forward branches not taken, as for
+     * if/else; backward branches are usually loop edges and stay exits.
+     */
+    return translator_is_trace(db) && taken > db->pc_next &&
+           translator_follow_jump(db, fallthrough);
+}
+
+#define CPU_OFS(F)  (offsetof(CPUState, F) - sizeof(CPUState))
+
+/*
+ * Indirect branches go through the inline caches only from TBs that may
+ * use goto_ptr and that are not one-off; plugins and the exec log need
+ * to see each jump through helper_lookup_tb_ptr.  The caches are keyed
+ * by tb->pc, so CF_PCREL TBs cannot use them.
+ *
+ * In system emulation, a change in the guest mappings makes the caches
+ * stale without invalidating any TB; only the per-vCPU jump caches
+ * follow those, so the lookup helper is always used there.
+ */
+static bool translator_use_ic(DisasContextBase *db)
+{
+#ifdef CONFIG_USER_ONLY
+    return !(tb_cflags(db->tb) & (CF_NO_GOTO_PTR | CF_NOIRQ | CF_COUNT_MASK |
+                                  CF_SINGLE_STEP | CF_BP_PAGE | CF_PCREL)) &&
+           !db->plugin_enabled &&
+           !qemu_loglevel_mask(CPU_LOG_TB_CPU | CPU_LOG_EXEC);
+#else
+    return false;
+#endif
+}
+
+/* Jump to the TB recorded in @ic for @dest, or branch to @miss. */
+static void gen_goto_ic(TCGv_ptr ic, TCGv_i64 dest, TCGLabel *miss)
+{
+    TCGv_i32 t32 = tcg_temp_new_i32();
+    TCGv_i32 gen = tcg_temp_new_i32();
+    TCGv_i64 pc = tcg_temp_new_i64();
+    TCGv_ptr tb = tcg_temp_new_ptr();
+
+    /* Entries older than the last eviction may point to reused memory. */
+    tcg_gen_ld_i32(gen, tcg_constant_ptr(&tb_ctx.tb_evict_count), 0);
+    tcg_gen_ld_i32(t32, ic, offsetof(TBInlineCache, gen));
+    tcg_gen_brcond_i32(TCG_COND_NE, t32, gen, miss);
+    tcg_gen_mb(TCG_MO_LD_LD | TCG_BAR_SC);
+
+    for (int i = 0; i < TB_IC_WAYS; i++) {
+        TCGLabel *next = i + 1 < TB_IC_WAYS ? gen_new_label() : miss;
+
+        /* Entries are filled in order, so the first NULL ends the search. */
+        tcg_gen_ld_ptr(tb, ic, offsetof(TBInlineCache, tb[i]));
+        tcg_gen_brcondi_ptr(TCG_COND_EQ, tb, 0, miss);
+        tcg_gen_ld_i64(pc, tb, offsetof(TranslationBlock, pc));
+        tcg_gen_brcond_i64(TCG_COND_NE, pc, dest, next);
+        tcg_gen_ld_i32(t32, tb, offsetof(TranslationBlock, cflags));
+        tcg_gen_andi_i32(t32, t32, CF_INVALID);
+        tcg_gen_brcondi_i32(TCG_COND_NE, t32, 0, next);
+        tcg_gen_ld_ptr(tb, tb, offsetof(TranslationBlock, tc.ptr));
+        tcg_gen_goto_ptr(tb);
+
+        if (next != miss) {
+            gen_set_label(next);
+        }
+    }
+}
+
+/* Look up the next TB, filling inline cache @idx of @owner. */
+static void gen_fill_ic(TCGv_ptr owner, int idx)
+{
+    TCGv_ptr host = tcg_temp_new_ptr();
+
+    gen_helper_lookup_tb_ptr_ic(host, tcg_env, owner, tcg_constant_i32(idx));
+    tcg_gen_goto_ptr(host);
+}
+
+/* Point @entry at the return address stack entry @top, scaled below. */
+static void gen_ras_entry(TCGv_ptr entry, TCGv_i32 top)
+{
+    TCGv_i32 ofs = tcg_temp_new_i32();
+
+    QEMU_BUILD_BUG_ON(sizeof_field(CPUState, tb_ras_pc[0]) != 8);
+    QEMU_BUILD_BUG_ON(sizeof_field(CPUState, tb_ras_tb[0]) != 8);
+    tcg_gen_shli_i32(ofs, top, 3);
+    tcg_gen_ext_i32_ptr(entry, ofs);
+    tcg_gen_add_ptr(entry, entry, tcg_env);
+}
+
+void translator_goto_ptr(DisasContextBase *db, TCGv_i64 dest)
+{
+    TCGLabel *miss;
+
+    if (!translator_use_ic(db)) {
+        tcg_gen_lookup_and_goto_ptr();
+        return;
+    }
+
+    miss = gen_new_label();
+    gen_goto_ic(tcg_constant_ptr(&db->tb->ic[TB_IC_JMP]), dest, miss);
+
+    gen_set_label(miss);
+    gen_fill_ic(tcg_constant_ptr(db->tb), TB_IC_JMP);
+}
+
+void translator_call(DisasContextBase *db, TCGv_i64 ret)
+{
+    TCGv_i32 top;
+    TCGv_ptr entry;
+
+    if (!translator_use_ic(db)) {
+        return;
+    }
+
+    top = tcg_temp_new_i32();
+    entry = tcg_temp_new_ptr();
+
+    tcg_gen_ld_i32(top, tcg_env, CPU_OFS(tb_ras_top));
+    gen_ras_entry(entry, top);
+    tcg_gen_st_i64(ret, entry, CPU_OFS(tb_ras_pc));
+    tcg_gen_st_ptr(tcg_constant_ptr(db->tb), entry, CPU_OFS(tb_ras_tb));
+    tcg_gen_addi_i32(top, top, 1);
+    tcg_gen_andi_i32(top, top, TB_RAS_SIZE - 1);
+    tcg_gen_st_i32(top, tcg_env, CPU_OFS(tb_ras_top));
+}
+
+void translator_return(DisasContextBase *db, TCGv_i64 dest)
+{
+    TCGLabel *miss, *fill;
+    TCGv_i32 top, flags;
+    TCGv_ptr entry, owner, ic;
+    TCGv_i64 t;
+
+    if (!translator_use_ic(db)) {
+        tcg_gen_lookup_and_goto_ptr();
+        return;
+    }
+
+    miss = gen_new_label();
+    fill = gen_new_label();
+    top = tcg_temp_new_i32();
+    flags = tcg_temp_new_i32();
+    entry = tcg_temp_new_ptr();
+    owner = tcg_temp_new_ptr();
+    ic = tcg_temp_new_ptr();
+    t = tcg_temp_new_i64();
+
+    /* Pop, whether or not the prediction turns out right. */
+    tcg_gen_ld_i32(top, tcg_env, CPU_OFS(tb_ras_top));
+    tcg_gen_subi_i32(top, top, 1);
+    tcg_gen_andi_i32(top, top, TB_RAS_SIZE - 1);
+    tcg_gen_st_i32(top, tcg_env, CPU_OFS(tb_ras_top));
+    gen_ras_entry(entry, top);
+
+    /*
+     * A non-NULL entry points to a TB whose memory is still there:
+     * reclaiming TBs drops the return address stack of every vCPU.
+     */
+    tcg_gen_ld_ptr(owner, entry, CPU_OFS(tb_ras_tb));
+    tcg_gen_brcondi_ptr(TCG_COND_EQ, owner, 0, miss);
+    tcg_gen_ld_i64(t, entry, CPU_OFS(tb_ras_pc));
+    tcg_gen_brcond_i64(TCG_COND_NE, t, dest, miss);
+
+    /*
+     * The cache of the call holds a TB with the flags of the call; this
+     * return must not change them, just as the call must not have.
+     */
+    tcg_gen_ld_i32(flags, owner, offsetof(TranslationBlock, flags));
+    tcg_gen_brcondi_i32(TCG_COND_NE, flags, db->tb->flags, miss);
+    tcg_gen_ld_i64(t, owner, offsetof(TranslationBlock, cs_base));
+    tcg_gen_brcondi_i64(TCG_COND_NE, t, db->tb->cs_base, miss);
+
+    tcg_gen_addi_ptr(ic, owner, offsetof(TranslationBlock, ic[TB_IC_RET]));
+    gen_goto_ic(ic, dest, fill);
+
+    gen_set_label(fill);
+    gen_fill_ic(owner, TB_IC_RET);
+
+    gen_set_label(miss);
+    tcg_gen_lookup_and_goto_ptr();
+}
+
 void translator_loop(CPUState *cpu, TranslationBlock *tb, int *max_insns,
                      vaddr pc, void *host_pc, const TranslatorOps *ops,
                      DisasContextBase *db, TCGType addr_type)
@@ -126,6 +390,7 @@ void translator_loop(CPUState *cpu, TranslationBlock *tb, int *max_insns,
     uint32_t cflags = tb_cflags(tb);
     TCGOp *icount_start_insn;
     TCGOp *first_insn_start = NULL;
+    TCGLabel *tier_label;
     bool plugin_enabled;
 
     tcg_ctx->addr_type = addr_type;
@@ -149,7 +414,7 @@ void translator_loop(CPUState *cpu, TranslationBlock *tb, int *max_insns,
     tcg_debug_assert(db->is_jmp == DISAS_NEXT);  /* no early exit */
 
     /* Start translating.  */
-    icount_start_insn = gen_tb_start(db, cflags);
+    icount_start_insn = gen_tb_start(db, cflags, &tier_label);
     ops->tb_start(db, cpu);
     tcg_debug_assert(db->is_jmp == DISAS_NEXT);  /* no early exit */
 
@@ -205,7 +470,7 @@ void translator_loop(CPUState *cpu, TranslationBlock *tb, int *max_insns,
 
     /* Emit code to exit the TB, as indicated by db->is_jmp.  */
     ops->tb_stop(db, cpu);
-    gen_tb_end(tb, cflags, icount_start_insn, db->num_insns);
+    gen_tb_end(tb, cflags, icount_start_insn, tier_label, db->num_insns);
 
     /*
      * Manage can_do_io for the translation block: set to false before
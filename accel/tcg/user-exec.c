@@ -24,6 +24,7 @@
 #include "tcg/tcg.h"
 #include "qemu/bitops.h"
 #include "qemu/rcu.h"
+#include "qemu/seqlock.h"
 #include "accel/tcg/cpu-ldst-common.h"
 #include "accel/tcg/cpu-loop.h"
 #include "accel/tcg/helper-retaddr.h"
@@ -35,6 +36,7 @@
 #include "exec/page-protection.h"
 #include "exec/helper-proto-common.h"
 #include "qemu/atomic128.h"
+#include "host/atomic-unaligned.h.inc"
 #include "qemu/bswap.h"
 #include "qemu/int128.h"
 #include "trace.h"
@@ -168,6 +170,25 @@ typedef struct PageFlagsNode {
 
 static IntervalTreeRoot pageflags_root;
 
+/*
+ * The tree is only modified with the mmap lock held, within a write
+ * section of pageflags_seq.  Lockless readers retry their lookup when
+ * the sequence has moved, instead of falling back to the mmap lock for
+ * the false negatives of a lookup that raced with a rebalance.
+ */
+static QemuSeqLock pageflags_seq;
+
+/* A copy of one interval, valid while pageflags_seq reads @seq. */
+typedef struct PageFlagsCache {
+    vaddr start;
+    vaddr last;
+    unsigned seq;
+    int flags;
+} PageFlagsCache;
+
+/* The interval of the last lockless lookup made by this thread. */
+static __thread PageFlagsCache pageflags_cache;
+
 static PageFlagsNode *pageflags_find(vaddr start, vaddr last)
 {
     IntervalTreeNode *n;
@@ -176,6 +197,52 @@ static PageFlagsNode *pageflags_find(vaddr start, vaddr last)
     return n ? container_of(n, PageFlagsNode, itree) : NULL;
 }
 
+/*
+ * Copy the first interval overlapping [start,last] to @r, if any.
+ * This does not require the mmap lock.
+ */
+static bool pageflags_lookup(vaddr start, vaddr last, PageFlagsCache *r)
+{
+    PageFlagsCache *c = &pageflags_cache;
+    PageFlagsNode *p;
+    unsigned seq;
+
+    if (have_mmap_lock()) {
+        p = pageflags_find(start, last);
+        if (!p) {
+            return false;
+        }
+        r->start = p->itree.start;
+        r->last = p->itree.last;
+        r->flags = p->flags;
+        return true;
+    }
+
+    seq = seqlock_read_begin(&pageflags_seq);
+    if (c->flags && c->seq == seq && c->start <= start && start <= c->last) {
+        *r = *c;
+        return true;
+    }
+
+    WITH_RCU_READ_LOCK_GUARD() {
+        do {
+            seq = seqlock_read_begin(&pageflags_seq);
+            p = pageflags_find(start, last);
+            if (p) {
+                r->start = p->itree.start;
+                r->last = p->itree.last;
+                r->flags = p->flags;
+            }
+        } while (seqlock_read_retry(&pageflags_seq, seq));
+    }
+    if (!p) {
+        return false;
+    }
+    r->seq = seq;
+    *c = *r;
+    return true;
+}
+
 static PageFlagsNode *pageflags_next(PageFlagsNode *p, vaddr start, vaddr last)
 {
     IntervalTreeNode *n;
@@ -239,24 +306,9 @@ void page_dump(FILE *f)
 
 int page_get_flags(vaddr address)
 {
-    PageFlagsNode *p = pageflags_find(address, address);
+    PageFlagsCache r;
 
-    /*
-     * See util/interval-tree.c re lockless lookups: no false positives but
-     * there are false negatives.  If we find nothing, retry with the mmap
-     * lock acquired.
-     */
-    if (p) {
-        return p->flags;
-    }
-    if (have_mmap_lock()) {
-        return 0;
-    }
-
-    mmap_lock();
-    p = pageflags_find(address, address);
-    mmap_unlock();
-    return p ? p->flags : 0;
+    return pageflags_lookup(address, address, &r) ? r.flags : 0;
 }
 
 /* A subroutine of page_set_flags: insert a new node for [start,last]. */
@@ -324,6 +376,7 @@ static bool pageflags_set_clear(vaddr start, vaddr last,
     int p_flags, merge_flags;
     bool inval_tb = false;
 
+    seqlock_write_begin(&pageflags_seq);
  restart:
     p = pageflags_find(start, last);
     if (!p) {
@@ -453,6 +506,7 @@ static bool pageflags_set_clear(vaddr start, vaddr last,
     }
 
  done:
+    seqlock_write_end(&pageflags_seq);
     return inval_tb;
 }
 
@@ -492,9 +546,8 @@ void page_set_flags(vaddr start, vaddr last, int set_flags, int clear_flags)
 
 bool page_check_range(vaddr start, vaddr len, int flags)
 {
+    PageFlagsCache r;
     vaddr last;
-    int locked;  /* tri-state: =0: unlocked, +1: global, -1: local */
-    bool ret;
 
     if (len == 0) {
         return true;  /* trivial length */
@@ -505,67 +558,41 @@ bool page_check_range(vaddr start, vaddr len, int flags)
         return false; /* wrap around */
     }
 
-    locked = have_mmap_lock();
     while (true) {
-        PageFlagsNode *p = pageflags_find(start, last);
         int missing;
 
-        if (!p) {
-            if (!locked) {
-                /*
-                 * Lockless lookups have false negatives.
-                 * Retry with the lock held.
-                 */
-                mmap_lock();
-                locked = -1;
-                p = pageflags_find(start, last);
-            }
-            if (!p) {
-                ret = false; /* entire region invalid */
-                break;
-            }
+        if (!pageflags_lookup(start, last, &r)) {
+            return false; /* entire region invalid */
         }
-        if (start < p->itree.start) {
-            ret = false; /* initial bytes invalid */
-            break;
+        if (start < r.start) {
+            return false; /* initial bytes invalid */
         }
 
-        missing = flags & ~p->flags;
+        missing = flags & ~r.flags;
         if (missing & ~PAGE_WRITE) {
-            ret = false; /* page doesn't match */
-            break;
+            return false; /* page doesn't match */
         }
         if (missing & PAGE_WRITE) {
-            if (!(p->flags & PAGE_WRITE_ORG)) {
-                ret = false; /* page not writable */
-                break;
+            if (!(r.flags & PAGE_WRITE_ORG)) {
+                return false; /* page not writable */
             }
             /* Asking about writable, but has been protected: undo. */
             if (!page_unprotect(NULL, start, 0)) {
-                ret = false;
-                break;
+                return false;
             }
             /* TODO: page_unprotect should take a range, not a single page. */
             if (last - start < TARGET_PAGE_SIZE) {
-                ret = true; /* ok */
-                break;
+                return true; /* ok */
             }
             start += TARGET_PAGE_SIZE;
             continue;
         }
 
-        if (last <= p->itree.last) {
-            ret = true; /* ok */
-            break;
+        if (last <= r.last) {
+            return true; /* ok */
         }
-        start = p->itree.last + 1;
-    }
-
-    /* Release the lock if acquired locally. */
-    if (locked < 0) {
-        mmap_unlock();
+        start = r.last + 1;
     }
-    return ret;
 }
 
 bool page_check_range_empty(vaddr start, vaddr last)
@@ -1213,7 +1240,10 @@ uint64_t cpu_ldq_code_mmu(CPUArchState *env, vaddr addr,
 #include "ldst_common.c.inc"
 
 /*
- * Do not allow unaligned operations to proceed.  Return the host address.
+ * Do not allow unaligned operations to proceed, unless the guest allows
+ * them and host_atomic_unaligned_ok() says the host can perform them
+ * atomically in place; otherwise they restart in an exclusive section
+ * via cpu_loop_exit_atomic().  Return the host address.
  */
 static void *atomic_mmu_lookup(CPUState *cpu, vaddr addr, MemOpIdx oi,
                                int size, uintptr_t retaddr)
@@ -1227,12 +1257,16 @@ static void *atomic_mmu_lookup(CPUState *cpu, vaddr addr, MemOpIdx oi,
         cpu_loop_exit_sigbus(cpu, addr, MMU_DATA_STORE, retaddr);
     }
 
-    /* Enforce qemu required alignment.  */
-    if (unlikely(addr & (size - 1))) {
+    ret = g2h_vaddr(cpu, addr);
+
+    /*
+     * Enforce qemu required alignment, unless the host can perform
+     * the operation in place, which avoids stopping all other cpus.
+     */
+    if (unlikely(addr & (size - 1)) && !host_atomic_unaligned_ok(ret, size)) {
         cpu_loop_exit_atomic(cpu, retaddr);
     }
 
-    ret = g2h_vaddr(cpu, addr);
     set_helper_retaddr(retaddr);
     return ret;
 }
@@ -22,6 +22,7 @@
 #include "exec/cpu-common.h"
 #include "hw/core/cpu.h"
 #include "qemu/lockable.h"
+#include "qemu/timer.h"
 #include "trace/trace-root.h"
 
 QemuMutex qemu_cpu_list_lock;
@@ -29,6 +30,9 @@ static QemuCond exclusive_cond;
 static QemuCond exclusive_resume;
 static QemuCond qemu_work_cond;
 
+/* When the current exclusive section was entered, for tracing. */
+static int64_t exclusive_start_ns;
+
 /* >= 1 if a thread is inside start_exclusive/end_exclusive.  Written
  * under qemu_cpu_list_lock, read with atomic operations.
  */
@@ -193,6 +197,7 @@ void start_exclusive(void)
 {
     CPUState *other_cpu;
     int running_cpus;
+    int64_t t0 = 0;
 
     /* Ensure we are not running, or start_exclusive will be blocked. */
     g_assert(!current_cpu->running);
@@ -202,6 +207,11 @@ void start_exclusive(void)
         return;
     }
 
+    if (trace_event_get_state_backends(TRACE_START_EXCLUSIVE) ||
+        trace_event_get_state_backends(TRACE_END_EXCLUSIVE)) {
+        t0 = get_clock();
+    }
+
     qemu_mutex_lock(&qemu_cpu_list_lock);
     exclusive_idle();
 
@@ -230,6 +240,12 @@ void start_exclusive(void)
     qemu_mutex_unlock(&qemu_cpu_list_lock);
 
     current_cpu->exclusive_context_count = 1;
+
+    if (t0) {
+        exclusive_start_ns = get_clock();
+        trace_start_exclusive(current_cpu->cpu_index, running_cpus,
+                              exclusive_start_ns - t0);
+    }
 }
 
 /* Finish an exclusive operation.  */
@@ -240,6 +256,12 @@ void end_exclusive(void)
         return;
     }
 
+    if (exclusive_start_ns) {
+        trace_end_exclusive(current_cpu->cpu_index,
+                            get_clock() - exclusive_start_ns);
+        exclusive_start_ns = 0;
+    }
+
     qemu_mutex_lock(&qemu_cpu_list_lock);
     qatomic_set(&pending_cpus, 0);
     qemu_cond_broadcast(&exclusive_resume);
@@ -245,6 +245,21 @@ SRST
     Show dynamic compiler info.
 ERST
 
+#if defined(CONFIG_TCG)
+    {
+        .name       = "jit-hotness",
+        .args_type  = "",
+        .params     = "",
+        .help       = "show the most executed translation blocks",
+    },
+#endif
+
+SRST
+  ``info jit-hotness``
+    Show the most executed translation blocks, see the ``tier-threshold``
+    property of the TCG accelerator.
+ERST
+
     {
         .name       = "sync-profile",
         .args_type  = "mean:-m,no_coalesce:-n,max:i?",
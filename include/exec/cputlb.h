@@ -52,8 +52,10 @@ void tlb_reset_dirty_range_all(ram_addr_t start, ram_addr_t length);
  * address and attributes for the translation.
  *
  * At most one entry for a given virtual address is permitted. Only a
- * single TARGET_PAGE_SIZE region is mapped; @full->lg_page_size is only
- * used by tlb_flush_page.
+ * single TARGET_PAGE_SIZE region is mapped; @full->lg_page_size is used
+ * by tlb_flush_page.  If @full->lg_map_size is larger than
+ * TARGET_PAGE_BITS, the other target pages within that region may later
+ * be filled from @full without calling tlb_fill.
  */
 void tlb_set_page_full(CPUState *cpu, int mmu_idx, vaddr addr,
                        CPUTLBEntryFull *full);
@@ -43,6 +43,27 @@ struct tb_tc {
     size_t size;
 };
 
+/*
+ * A cache for an indirect branch, see translator_goto_ptr: the last
+ * TB_IC_WAYS TBs reached, most recent first, or NULL.  An entry is used
+ * only while the TB is valid, and while @gen, the tb_evict_count at the
+ * time the cache was filled, shows that the TB memory was not reclaimed.
+ * The cache is shared by all vCPUs, and each entry is read and written
+ * atomically.
+ */
+#define TB_IC_WAYS 2
+
+typedef struct TBInlineCache {
+    uint32_t gen;
+    TranslationBlock *tb[TB_IC_WAYS];
+} TBInlineCache;
+
+enum {
+    TB_IC_JMP,  /* the indirect jump ending the TB */
+    TB_IC_RET,  /* the return target of a call in the TB */
+    TB_IC_NB
+};
+
 struct TranslationBlock {
     /*
      * Guest PC corresponding to this block.  This must be the true
@@ -84,6 +105,7 @@ struct TranslationBlock {
 #define CF_NOIRQ         0x00010000 /* Generate an uninterruptible TB */
 #define CF_PCREL         0x00020000 /* Opcodes in TB are PC-relative */
 #define CF_BP_PAGE       0x00040000 /* Breakpoint present in code page */
+#define CF_TRACE         0x00080000 /* Hot retranslation; see tier-threshold */
 #define CF_CLUSTER_MASK  0xff000000 /* Top 8 bits are cluster ID */
 #define CF_CLUSTER_SHIFT 24
 
@@ -147,6 +169,16 @@ struct TranslationBlock {
     uintptr_t jmp_list_head;
     uintptr_t jmp_list_next[2];
     uintptr_t jmp_dest[2];
+
+    /*
+     * Tiered translation.  With -accel tcg,tier-threshold=N, the Nth
+     * entry into a tier-0 TB retranslates it as a trace.  CF_TRACE is
+     * dropped from cflags once translated, so that the trace replaces
+     * the tier-0 TB; @trace records it instead.
+     */
+    bool trace;
+
+    TBInlineCache ic[TB_IC_NB];
 };
 
 /* The alignment given to TranslationBlock during allocation. */
@@ -161,6 +161,72 @@ void translator_loop(CPUState *cpu, TranslationBlock *tb, int *max_insns,
  */
 bool translator_use_goto_tb(DisasContextBase *db, vaddr dest);
 
+/**
+ * translator_follow_jump
+ * @db: Disassembly context
+ * @dest: target pc of an unconditional direct jump
+ *
+ * Return true if translation may continue at @dest within the current
+ * TB instead of ending it with goto_tb.  Guest state kept in TCG globals
+ * then stays in host registers across the jump.  On success the caller
+ * must redirect db->pc_next to @dest and must not let the TB extend past
+ * the end of the first page.
+ */
+bool translator_follow_jump(DisasContextBase *db, vaddr dest);
+
+/**
+ * translator_is_trace
+ * @db: Disassembly context
+ *
+ * Return true if the TB is a hot retranslation (CF_TRACE), see the
+ * tier-threshold property of the TCG accelerator.
+ */
+bool translator_is_trace(const DisasContextBase *db);
+
+/**
+ * translator_follow_branch
+ * @db: Disassembly context
+ * @taken: target pc of a conditional direct branch
+ * @fallthrough: pc of the insn following the branch
+ *
+ * Return true if a trace may continue translating at @fallthrough,
+ * leaving the TB through a side exit when the branch is taken.  The
+ * side exit must not use goto_tb.
+ */
+bool translator_follow_branch(DisasContextBase *db, vaddr taken,
+                              vaddr fallthrough);
+
+/**
+ * translator_goto_ptr
+ * @db: Disassembly context
+ * @dest: target pc of an indirect jump, already stored in the cpu state
+ *
+ * As tcg_gen_lookup_and_goto_ptr, but first try the target last seen
+ * at this jump, without calling the helper.  Use only for jumps that
+ * leave the state of get_tb_cpu_state other than pc unchanged.
+ */
+void translator_goto_ptr(DisasContextBase *db, TCGv_i64 dest);
+
+/**
+ * translator_call
+ * @db: Disassembly context
+ * @ret: return address of a call
+ *
+ * Push @ret on the return address stack, for translator_return.
+ * The call must not change the state of get_tb_cpu_state other than pc.
+ */
+void translator_call(DisasContextBase *db, TCGv_i64 ret);
+
+/**
+ * translator_return
+ * @db: Disassembly context
+ * @dest: target pc of a return, already stored in the cpu state
+ *
+ * As translator_goto_ptr, predicting @dest from the return address
+ * stack instead of from the previous target of the jump.
+ */
+void translator_return(DisasContextBase *db, TCGv_i64 dest);
+
 /**
  * translator_io_start
  * @db: Disassembly context
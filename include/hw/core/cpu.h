@@ -206,6 +206,9 @@ typedef uint32_t MMUIdxMap;
 /* Use a fully associative victim tlb of 8 entries. */
 #define CPU_VTLB_SIZE 8
 
+/* Use a fully associative large page tlb of 16 entries. */
+#define CPU_LTLB_SIZE 16
+
 /*
  * The full TLB entry, which is not accessed by generated TCG code,
  * so the layout is not as critical as that of CPUTLBEntry. This is
@@ -239,6 +242,15 @@ struct CPUTLBEntryFull {
     /* @lg_page_size contains the log2 of the page size. */
     uint8_t lg_page_size;
 
+    /*
+     * @lg_map_size contains the log2 of the size of the aligned region,
+     * no larger than the page, over which the physical address is
+     * contiguous and all other fields are the same; or 0 if unknown.
+     * If larger than TARGET_PAGE_BITS, the other target pages within
+     * the region may be filled without calling tlb_fill again.
+     */
+    uint8_t lg_map_size;
+
     /* Additional tlb flags requested by tlb_fill. */
     uint8_t tlb_fill_flags;
 
@@ -274,11 +286,32 @@ struct CPUTLBEntryFull {
  * Data elements that are per MMU mode, minus the bits accessed by
  * the TCG fast path.
  */
+/*
+ * A page larger than TARGET_PAGE_SIZE, of which at least one target
+ * page has been allocated into the tlb.
+ */
+typedef struct CPUTLBLargePage {
+    /* The virtual address of the page, or -1 if unused. */
+    vaddr addr;
+    /* The mask of the page, ~(size - 1). */
+    vaddr mask;
+    /* The target page most recently filled from the page. */
+    vaddr fill_addr;
+    /* The translation of fill_addr, as passed to tlb_set_page_full. */
+    CPUTLBEntryFull full;
+} CPUTLBLargePage;
+
 typedef struct CPUTLBDesc {
     /*
-     * Describe a region covering all of the large pages allocated
-     * into the tlb.  When any page within this region is flushed,
-     * we must flush the entire tlb.  The region is matched if
+     * The large pages allocated into the tlb.  When any page within
+     * one of these is flushed, we flush the target pages of that
+     * large page.
+     */
+    CPUTLBLargePage ltable[CPU_LTLB_SIZE];
+    /*
+     * Describe a region covering all of the large pages evicted from
+     * ltable.  When any page within this region is flushed, we must
+     * flush the entire tlb.  The region is matched if
      * (addr & large_page_mask) == large_page_addr.
      */
     vaddr large_page_addr;
@@ -296,6 +329,18 @@ typedef struct CPUTLBDesc {
     CPUTLBEntryFull *fulltlb;
 } CPUTLBDesc;
 
+/*
+ * A page range flush requested by another vCPU.
+ */
+typedef struct CPUTLBPendingRange {
+    vaddr addr;
+    vaddr len;
+    MMUIdxMap idxmap;
+    unsigned bits;
+} CPUTLBPendingRange;
+
+#define CPU_TLB_PENDING_RANGES 8
+
 /*
  * Data elements that are shared between all MMU modes.
  */
@@ -308,6 +353,24 @@ typedef struct CPUTLBCommon {
      * Protected by tlb_c.lock.
      */
     MMUIdxMap dirty;
+    /*
+     * Flushes queued by other vCPUs, coalesced and applied by this vCPU
+     * at its next cpu_exec loop boundary.  Protected by tlb_c.lock.
+     * Ranges that do not fit are folded into pending_full.
+     */
+    MMUIdxMap pending_full;
+    unsigned pending_nb_ranges;
+    CPUTLBPendingRange pending_range[CPU_TLB_PENDING_RANGES];
+    /*
+     * pending_req counts the requests queued, under tlb_c.lock;
+     * pending_ack is the value of pending_req when this vCPU last
+     * drained its queue.  Other vCPUs wait on the latter for the
+     * "synced" flushes.
+     */
+    uint32_t pending_req;
+    uint32_t pending_ack;
+    /* Wait for the other vCPUs to drain before executing further. */
+    bool sync_wait;
     /*
      * Statistics.  These are not lock protected, but are read and
      * written atomically.  This allows the monitor to print a snapshot
@@ -402,6 +465,8 @@ struct qemu_work_item;
 
 #define CPU_UNSET_NUMA_NODE_ID -1
 
+#define TB_RAS_SIZE 16
+
 /**
  * struct CPUState - common state of one CPU core or thread.
  *
@@ -519,6 +584,24 @@ struct CPUState {
     MemoryRegion *memory;
 
     struct CPUJumpCache *tb_jmp_cache;
+    /* Translations done on a lookup miss, and the time spent on them */
+    uint64_t tb_gen_count;
+    uint64_t tb_gen_ns;
+    /*
+     * With -accel tcg,tier-threshold=N, the entries into tier-0 TBs,
+     * hashed by TB.  Only this CPU writes to it, so that counting needs
+     * no atomics and shares no cache lines.
+     */
+    uint32_t *tb_exec_count;
+    /*
+     * Return address stack for translator_return, pushed by
+     * translator_call: a ring of TB_RAS_SIZE entries, kept as separate
+     * arrays so that one scaled index addresses both.  @tb_ras_tb is
+     * the TB holding the TB_IC_RET inline cache of the call, or NULL.
+     */
+    uint32_t tb_ras_top;
+    vaddr tb_ras_pc[TB_RAS_SIZE];
+    TranslationBlock *tb_ras_tb[TB_RAS_SIZE];
 
     GArray *gdb_regs;
     int gdb_num_regs;
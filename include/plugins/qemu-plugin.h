@@ -84,11 +84,16 @@ typedef uint64_t qemu_plugin_id_t;
  * version 7:
  * - add userdata to all plugin callbacks, allowing maintenance of state
  *   externally, and easing interfacing with other languages.
+ *
+ * version 8:
+ * - added record buffers, filled inline by
+ *   qemu_plugin_register_vcpu_{insn_exec,mem}_record and handed to the
+ *   plugin in batches
  */
 
 extern QEMU_PLUGIN_EXPORT int qemu_plugin_version;
 
-#define QEMU_PLUGIN_VERSION 7
+#define QEMU_PLUGIN_VERSION 8
 
 /**
  * struct qemu_info_t - system information for plugins
@@ -799,6 +804,109 @@ void qemu_plugin_register_vcpu_mem_inline_per_vcpu(
     qemu_plugin_u64 entry,
     uint64_t imm);
 
+/**
+ * typedef qemu_plugin_record - an event appended to a record buffer
+ * @data: the value given when the record op was registered
+ * @vaddr: virtual address of the memory access, or of the instruction
+ * @info: memory transaction handle, 0 for instruction records
+ */
+typedef struct {
+    uint64_t data;
+    uint64_t vaddr;
+    qemu_plugin_meminfo_t info;
+} qemu_plugin_record;
+
+/** struct qemu_plugin_record_buffer - Opaque handle for a record buffer */
+struct qemu_plugin_record_buffer;
+
+/**
+ * typedef qemu_plugin_vcpu_records_cb_t - record buffer callback type
+ * @vcpu_index: the vCPU which recorded the events
+ * @records: the events, oldest first
+ * @n: number of events
+ * @userdata: user data for callback
+ *
+ * @records are only valid for the duration of the callback.
+ */
+typedef void (*qemu_plugin_vcpu_records_cb_t)(unsigned int vcpu_index,
+                                              const qemu_plugin_record *records,
+                                              size_t n, void *userdata);
+
+/**
+ * qemu_plugin_record_buffer_new() - alloc a new record buffer
+ * @size: number of records each vCPU can hold
+ * @cb: callback receiving the records of a vCPU
+ * @userdata: user data for callback
+ *
+ * Record ops append events to the buffer of the executing vCPU from
+ * generated code, without calling into the plugin. When the buffer of
+ * a vCPU has no room for the records an instruction is about to append,
+ * @cb is called on that vCPU with all of its records, and the buffer is
+ * emptied. As room is made for a whole instruction at once, @cb may be
+ * called with fewer than @size records.
+ *
+ * Returns a pointer to a new record buffer. It must be freed using
+ * qemu_plugin_record_buffer_free.
+ */
+QEMU_PLUGIN_API
+struct qemu_plugin_record_buffer *
+qemu_plugin_record_buffer_new(size_t size, qemu_plugin_vcpu_records_cb_t cb,
+                              void *userdata);
+
+/**
+ * qemu_plugin_record_buffer_free() - free a record buffer
+ * @buf: record buffer to free
+ *
+ * Pending records are discarded.
+ */
+QEMU_PLUGIN_API
+void qemu_plugin_record_buffer_free(struct qemu_plugin_record_buffer *buf);
+
+/**
+ * qemu_plugin_record_buffer_flush() - hand pending records to the plugin
+ * @buf: record buffer
+ * @vcpu_index: vCPU whose records are consumed
+ *
+ * Call the callback of @buf with the records of @vcpu_index, if any,
+ * and empty its buffer. This must be called from a callback running on
+ * @vcpu_index, or once the vCPU has stopped, e.g. at exit.
+ */
+QEMU_PLUGIN_API
+void qemu_plugin_record_buffer_flush(struct qemu_plugin_record_buffer *buf,
+                                     unsigned int vcpu_index);
+
+/**
+ * qemu_plugin_register_vcpu_insn_exec_record() - record insn execution
+ * @insn: the opaque qemu_plugin_insn handle for an instruction
+ * @buf: record buffer
+ * @data: data of the record
+ *
+ * Append a record every time the instruction executes. Its vaddr is
+ * the one of the instruction.
+ */
+QEMU_PLUGIN_API
+void qemu_plugin_register_vcpu_insn_exec_record(
+    struct qemu_plugin_insn *insn,
+    struct qemu_plugin_record_buffer *buf,
+    uint64_t data);
+
+/**
+ * qemu_plugin_register_vcpu_mem_record() - record memory accesses
+ * @insn: handle for instruction to instrument
+ * @buf: record buffer
+ * @rw: record reads, writes or both
+ * @data: data of the record
+ *
+ * Append a record for every memory access generated by the
+ * instruction, with the virtual address and info of the access.
+ */
+QEMU_PLUGIN_API
+void qemu_plugin_register_vcpu_mem_record(
+    struct qemu_plugin_insn *insn,
+    struct qemu_plugin_record_buffer *buf,
+    enum qemu_plugin_mem_rw rw,
+    uint64_t data);
+
 /**
  * qemu_plugin_request_time_control() - request the ability to control time
  *
@@ -72,6 +72,7 @@ enum plugin_dyn_cb_type {
     PLUGIN_CB_MEM_REGULAR,
     PLUGIN_CB_INLINE_ADD_U64,
     PLUGIN_CB_INLINE_STORE_U64,
+    PLUGIN_CB_INLINE_RECORD,
 };
 
 struct qemu_plugin_regular_cb {
@@ -87,6 +88,13 @@ struct qemu_plugin_inline_cb {
     enum qemu_plugin_mem_rw rw;
 };
 
+struct qemu_plugin_record_cb {
+    struct qemu_plugin_record_buffer *buf;
+    uint64_t data;
+    uint64_t vaddr;
+    enum qemu_plugin_mem_rw rw;
+};
+
 struct qemu_plugin_conditional_cb {
     union qemu_plugin_cb_sig f;
     TCGHelperInfo *info;
@@ -107,6 +115,7 @@ struct qemu_plugin_dyn_cb {
         struct qemu_plugin_regular_cb regular;
         struct qemu_plugin_conditional_cb cond;
         struct qemu_plugin_inline_cb inline_insn;
+        struct qemu_plugin_record_cb record;
     };
 };
 
@@ -128,6 +137,19 @@ struct qemu_plugin_scoreboard {
     QLIST_ENTRY(qemu_plugin_scoreboard) entry;
 };
 
+/* The scoreboard entry of a record buffer */
+struct qemu_plugin_record_vcpu {
+    uint64_t n;
+    qemu_plugin_record records[];
+};
+
+struct qemu_plugin_record_buffer {
+    struct qemu_plugin_scoreboard *score;
+    size_t size;
+    qemu_plugin_vcpu_records_cb_t cb;
+    void *userp;
+};
+
 /* Internal context for this TranslationBlock */
 struct qemu_plugin_tb {
     GPtrArray *insns;
@@ -185,6 +207,19 @@ void qemu_plugin_atexit_cb(void);
 
 void qemu_plugin_add_dyn_cb_arr(GArray *arr);
 
+/*
+ * Hand the records of a record buffer to the plugin, to make room.
+ * Called from generated code, hence the qemu_plugin_vcpu_udata_cb_t type.
+ */
+void qemu_plugin_vcpu_record_flush(unsigned int vcpu_index, void *buf);
+
+/*
+ * Append a record to a record buffer, making room if it is full.
+ * Called from generated code where it cannot check for room itself.
+ */
+void qemu_plugin_vcpu_record(unsigned int vcpu_index, void *buf,
+                             uint64_t data, uint64_t vaddr, uint32_t info);
+
 static inline void qemu_plugin_disable_mem_helpers(CPUState *cpu)
 {
     cpu->neg.plugin_mem_cbs = NULL;
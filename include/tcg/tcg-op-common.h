@@ -31,6 +31,15 @@ TCGv_i32 tcg_global_mem_new_i32(TCGv_ptr reg, intptr_t off, const char *name);
 TCGv_i64 tcg_global_mem_new_i64(TCGv_ptr reg, intptr_t off, const char *name);
 TCGv_ptr tcg_global_mem_new_ptr(TCGv_ptr reg, intptr_t off, const char *name);
 
+/*
+ * Declare a global as holding (inputs to) guest condition flags.
+ * Liveness tracks such globals across forward branches within the TB,
+ * so that a flag value overwritten on every path before it is read
+ * need not be stored back to env at the branch.
+ */
+void tcg_global_set_flag_i32(TCGv_i32 v);
+void tcg_global_set_flag_i64(TCGv_i64 v);
+
 /* Generic ops.  */
 static inline void tcg_gen_insn_start(uint64_t pc, uint64_t a1,
                                       uint64_t a2)
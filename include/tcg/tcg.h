@@ -101,6 +101,8 @@ struct TCGLabel {
     bool present;
     bool has_value;
     uint16_t id;
+    /* Flag globals dead on entry to the label; set by liveness_pass_1. */
+    uint32_t dead_flags;
     union {
         uintptr_t value;
         const tcg_insn_unit *value_ptr;
@@ -120,6 +122,7 @@ typedef struct TCGPool {
 
 #define TCG_MAX_TEMPS 512
 #define TCG_MAX_INSNS 512
+#define TCG_MAX_FLAG_GLOBALS 32
 
 /* when the size of the arguments of a called function is smaller than
    this value, they are statically allocated in the TB stack frame */
@@ -343,6 +346,18 @@ static inline TCGRegSet output_pref(const TCGOp *op, unsigned i)
     return i < ARRAY_SIZE(op->output_pref) ? op->output_pref[i] : 0;
 }
 
+/*
+ * Op counts of tcg_optimize, summed over the translations of one
+ * TCGContext; see tcg_get_opt_stats.
+ */
+typedef struct TCGOptStats {
+    uint64_t ops_in;
+    uint64_t ops_out;
+    uint64_t ld_fwd;    /* env loads replaced by a copy */
+    uint64_t cse;       /* ops replaced by a copy of an earlier result */
+    uint64_t dead_st;   /* env stores overwritten before any read */
+} TCGOptStats;
+
 struct TCGContext {
     uintptr_t pool_cur, pool_end;
     TCGPool *pool_first, *pool_current, *pool_first_large;
@@ -350,6 +365,7 @@ struct TCGContext {
     int nb_globals;
     int nb_temps;
     int nb_indirects;
+    int nb_flag_globals;
     int nb_ops;
     TCGType addr_type;            /* TCG_TYPE_I32 or TCG_TYPE_I64 */
     TCGBar guest_mo;
@@ -419,6 +435,7 @@ struct TCGContext {
     GHashTable *const_table[TCG_TYPE_COUNT];
     TCGTempSet free_temps[TCG_TYPE_COUNT];
     TCGTemp temps[TCG_MAX_TEMPS]; /* globals first, temps after */
+    uint16_t flag_globals[TCG_MAX_FLAG_GLOBALS]; /* indexes into temps */
 
     QTAILQ_HEAD(, TCGOp) ops, free_ops;
     QSIMPLEQ_HEAD(, TCGLabel) labels;
@@ -436,6 +453,9 @@ struct TCGContext {
     uint16_t gen_insn_end_off[TCG_MAX_INSNS];
     uint64_t *gen_insn_data;
 
+    /* Written only by the owner, read by tcg_get_opt_stats. */
+    TCGOptStats opt_stats;
+
     /* Exit to translator on overflow. */
     sigjmp_buf jmp_trans;
 };
@@ -622,10 +642,16 @@ void tcg_pool_reset(TCGContext *s);
 TranslationBlock *tcg_tb_alloc(TCGContext *s);
 
 void tcg_region_reset_all(void);
+bool tcg_region_evict(void (*evict_tb)(TranslationBlock *tb));
+size_t tcg_nb_regions(void);
+size_t tcg_region_evictions(size_t idx);
 
 size_t tcg_code_size(void);
 size_t tcg_code_capacity(void);
 
+/* tcg_get_opt_stats: Sum the optimizer statistics of all contexts */
+void tcg_get_opt_stats(TCGOptStats *stats);
+
 /**
  * tcg_tb_insert:
  * @tb: translation block to insert
@@ -979,4 +1005,7 @@ void tcg_dump_ops(TCGContext *s, FILE *f, bool have_prefs);
 /* tcg_dump_stats: Append TCG statistics to @buf */
 void tcg_dump_stats(GString *buf);
 
+/* tcg_dump_hotness: Append the most executed TBs to @buf */
+void tcg_dump_hotness(GString *buf);
+
 #endif /* TCG_H */
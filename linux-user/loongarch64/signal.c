@@ -169,6 +169,7 @@ static void setup_sigframe(CPULoongArchState *env,
      * Set extension context
      */
 
+    loongarch_fcsr0_fold(env);
     if (FIELD_EX64(sys->CSR_EUEN, CSR_EUEN, ASXE)) {
         struct target_lasx_context *lasx_ctx;
         info = extctx->lasx.haddr;
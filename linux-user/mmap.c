@@ -28,6 +28,7 @@
 #include "user-mmap.h"
 #include "target_mman.h"
 #include "qemu/interval-tree.h"
+#include "qemu/timer.h"
 
 #ifdef TARGET_ARM
 #include "target/arm/cpu-features.h"
@@ -39,7 +40,14 @@ static __thread int mmap_lock_count;
 void mmap_lock(void)
 {
     if (mmap_lock_count++ == 0) {
-        pthread_mutex_lock(&mmap_mutex);
+        if (!trace_event_get_state_backends(TRACE_MMAP_LOCK_WAIT)) {
+            pthread_mutex_lock(&mmap_mutex);
+        } else if (pthread_mutex_trylock(&mmap_mutex) != 0) {
+            int64_t t0 = get_clock();
+
+            pthread_mutex_lock(&mmap_mutex);
+            trace_mmap_lock_wait(get_clock() - t0);
+        }
     }
 }
 
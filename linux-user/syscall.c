@@ -127,6 +127,9 @@
 #include <libdrm/drm.h>
 #include <libdrm/i915_drm.h>
 #endif
+#ifdef HAVE_IO_URING_H
+#include <linux/io_uring.h>
+#endif
 #include "linux_loop.h"
 #include "uname.h"
 
@@ -147,6 +150,11 @@
 #include "fd-trans.h"
 #include "user/cpu_loop.h"
 
+#if defined(HAVE_IO_URING_H) && defined(TARGET_NR_io_uring_setup) && \
+    defined(__NR_io_uring_setup)
+#define EMULATE_IO_URING
+#endif
+
 #if defined(__powerpc__)
 /*
  * On PowerPC termios2 is lacking and termios along with ioctls w/o 2
@@ -370,6 +378,18 @@ _syscall4(int, pidfd_send_signal, int, pidfd, int, sig, siginfo_t *, info,
 #if defined(__NR_pidfd_getfd) && defined(TARGET_NR_pidfd_getfd)
 _syscall3(int, pidfd_getfd, int, pidfd, int, targetfd, unsigned int, flags);
 #endif
+#ifdef EMULATE_IO_URING
+#define __NR_sys_io_uring_setup __NR_io_uring_setup
+#define __NR_sys_io_uring_enter __NR_io_uring_enter
+#define __NR_sys_io_uring_register __NR_io_uring_register
+_syscall2(int, sys_io_uring_setup, unsigned int, entries,
+          struct io_uring_params *, p)
+_syscall6(int, sys_io_uring_enter, int, fd, unsigned int, to_submit,
+          unsigned int, min_complete, unsigned int, flags,
+          const sigset_t *, sig, size_t, sigsz)
+_syscall4(int, sys_io_uring_register, int, fd, unsigned int, opcode,
+          void *, arg, unsigned int, nr_args)
+#endif
 #define __NR_sys_sched_getaffinity __NR_sched_getaffinity
 _syscall3(int, sys_sched_getaffinity, pid_t, pid, unsigned int, len,
           unsigned long *, user_mask_ptr);
@@ -723,6 +743,11 @@ safe_syscall6(int, epoll_pwait, int, epfd, struct epoll_event *, events,
 safe_syscall6(int, epoll_pwait2, int, epfd, struct epoll_event *, events,
               int, maxevents, struct timespec *, timeout_ts,
               const sigset_t *, sigmask, size_t, sigsetsize)
+#ifdef EMULATE_IO_URING
+safe_syscall6(int, io_uring_enter, int, fd, unsigned int, to_submit,
+              unsigned int, min_complete, unsigned int, flags,
+              const sigset_t *, sig, size_t, sigsz)
+#endif
 #if defined(__NR_futex)
 safe_syscall6(int,futex,int *,uaddr,int,op,int,val, \
               const struct timespec *,timeout,int *,uaddr2,int,val3)
@@ -3088,7 +3113,8 @@ static struct iovec *lock_iovec(int type, abi_ulong target_addr,
         return NULL;
     }
 
-    vec = g_try_new0(struct iovec, count);
+    /* Every element is filled in below, or the vector is freed. */
+    vec = g_try_new(struct iovec, count);
     if (vec == NULL) {
         errno = ENOMEM;
         return NULL;
@@ -3145,11 +3171,13 @@ static struct iovec *lock_iovec(int type, abi_ulong target_addr,
     return vec;
 
  fail:
+#ifdef CONFIG_DEBUG_REMAP
     while (--i >= 0) {
         if (tswapal(target_vec[i].iov_len) > 0) {
             unlock_user(vec[i].iov_base, tswapal(target_vec[i].iov_base), 0);
         }
     }
+#endif
     unlock_user(target_vec, target_addr, 0);
  fail2:
     g_free(vec);
@@ -3160,6 +3188,7 @@ static struct iovec *lock_iovec(int type, abi_ulong target_addr,
 static void unlock_iovec(struct iovec *vec, abi_ulong target_addr,
                          abi_ulong count, int copy)
 {
+#ifdef CONFIG_DEBUG_REMAP
     struct target_iovec *target_vec;
     int i;
 
@@ -3176,7 +3205,11 @@ static void unlock_iovec(struct iovec *vec, abi_ulong target_addr,
         }
         unlock_user(target_vec, target_addr, 0);
     }
-
+#endif
+    /*
+     * Otherwise the buffers are guest memory used in place, with nothing
+     * to write back, and the guest vector need not be read a second time.
+     */
     g_free(vec);
 }
 
@@ -6070,6 +6103,1041 @@ static const StructEntry struct_termios2_def = {
 };
 #endif
 
+#ifdef EMULATE_IO_URING
+/*
+ * The io_uring rings are shared with the kernel, so the guest cannot be
+ * given the host rings: every entry would need its byte order swapped
+ * and its pointers translated in place.  Instead each ring fd gets a
+ * set of guest rings in the layout below, which the guest maps at the
+ * usual IORING_OFF_* offsets.  io_uring_enter converts all newly queued
+ * guest SQEs into the host submission ring in one pass, makes a single
+ * host io_uring_enter for the whole batch, and moves host CQEs over to
+ * the guest completion ring.
+ *
+ * Completions only reach the guest ring during io_uring_enter, so the
+ * guest SQ ring always has IORING_SQ_TASKRUN set, which tells liburing
+ * to enter the kernel rather than spin on an empty completion ring.
+ */
+#define TARGET_IORING_SQ_HEAD       0
+#define TARGET_IORING_SQ_TAIL       4
+#define TARGET_IORING_SQ_MASK       8
+#define TARGET_IORING_SQ_ENTRIES    12
+#define TARGET_IORING_SQ_FLAGS      16
+#define TARGET_IORING_SQ_DROPPED    20
+#define TARGET_IORING_SQ_ARRAY      24
+
+#define TARGET_IORING_CQ_HEAD       0
+#define TARGET_IORING_CQ_TAIL       4
+#define TARGET_IORING_CQ_MASK       8
+#define TARGET_IORING_CQ_ENTRIES    12
+#define TARGET_IORING_CQ_OVERFLOW   16
+#define TARGET_IORING_CQ_FLAGS      20
+#define TARGET_IORING_CQ_CQES       32
+
+#define TARGET_IORING_SQ_CQ_OVERFLOW    (1U << 1)
+#define TARGET_IORING_SQ_TASKRUN        (1U << 2)
+
+/*
+ * SQPOLL would have the kernel read the guest ring behind our back, and
+ * the larger SQE/CQE formats are not converted.
+ */
+#define TARGET_IORING_SETUP_FLAGS \
+    (IORING_SETUP_IOPOLL | IORING_SETUP_CQSIZE | \
+     IORING_SETUP_CLAMP | IORING_SETUP_ATTACH_WQ)
+
+/* SINGLE_MMAP and EXT_ARG describe the host rings and enter ABI only. */
+#define TARGET_IORING_FEATURES \
+    (IORING_FEAT_NODROP | IORING_FEAT_SUBMIT_STABLE | \
+     IORING_FEAT_RW_CUR_POS | IORING_FEAT_CUR_PERSONALITY | \
+     IORING_FEAT_FAST_POLL | IORING_FEAT_POLL_32BITS)
+
+#define TARGET_IORING_MAX_REG_BUFFERS   (1U << 14)
+
+typedef struct TargetIoUring {
+    QemuMutex lock;
+    int refs;               /* protected by target_io_uring_lock */
+    uint32_t sq_entries;
+    uint32_t cq_entries;
+
+    /* Host rings, shared with the host kernel. */
+    void *sq_map;
+    void *cq_map;
+    size_t sq_map_size;
+    size_t cq_map_size;
+    struct io_uring_sqe *sqes;
+    uint32_t *sq_head;
+    uint32_t *sq_tail;
+    uint32_t *sq_array;
+    uint32_t sq_mask;
+    uint32_t *cq_head;
+    uint32_t *cq_tail;
+    struct io_uring_cqe *cqes;
+    uint32_t cq_mask;
+
+    /* Guest rings, 0 until the guest maps them. */
+    abi_ulong guest_sq;
+    abi_ulong guest_cq;
+    abi_ulong guest_sqes;
+    uint32_t guest_sq_head;
+    uint32_t guest_cq_tail;
+    uint32_t guest_dropped;
+
+    /* Completions, with target errnos, of SQEs not passed to the host. */
+    GArray *early_cqes;
+    /* Converted iovecs, timespecs, ... of SQEs not yet consumed. */
+    GPtrArray *scratch;
+} TargetIoUring;
+
+static QemuMutex target_io_uring_lock;
+static GHashTable *target_io_urings;
+
+static int maybe_do_fake_open(CPUArchState *cpu_env, int dirfd,
+                              const char *fname, int flags, mode_t mode,
+                              int openat2_resolve, bool safe);
+
+static void io_uring_init(void)
+{
+    qemu_mutex_init(&target_io_uring_lock);
+    target_io_urings = g_hash_table_new(NULL, NULL);
+}
+
+static TargetIoUring *io_uring_new(int fd, struct io_uring_params *p)
+{
+    size_t sq_size = p->sq_off.array + p->sq_entries * sizeof(uint32_t);
+    size_t cq_size = p->cq_off.cqes +
+                     p->cq_entries * sizeof(struct io_uring_cqe);
+    size_t sqes_size = p->sq_entries * sizeof(struct io_uring_sqe);
+    TargetIoUring *ring;
+    void *sq, *cq, *sqes;
+
+    if (p->features & IORING_FEAT_SINGLE_MMAP) {
+        sq_size = cq_size = MAX(sq_size, cq_size);
+    }
+    sq = mmap(NULL, sq_size, PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sq == MAP_FAILED) {
+        return NULL;
+    }
+    cq = sq;
+    if (!(p->features & IORING_FEAT_SINGLE_MMAP)) {
+        cq = mmap(NULL, cq_size, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (cq == MAP_FAILED) {
+            munmap(sq, sq_size);
+            return NULL;
+        }
+    }
+    sqes = mmap(NULL, sqes_size, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        if (cq != sq) {
+            munmap(cq, cq_size);
+        }
+        munmap(sq, sq_size);
+        return NULL;
+    }
+
+    ring = g_new0(TargetIoUring, 1);
+    qemu_mutex_init(&ring->lock);
+    ring->refs = 1;
+    ring->sq_entries = p->sq_entries;
+    ring->cq_entries = p->cq_entries;
+    ring->sq_map = sq;
+    ring->cq_map = cq;
+    ring->sq_map_size = sq_size;
+    ring->cq_map_size = cq_size;
+    ring->sqes = sqes;
+    ring->sq_head = sq + p->sq_off.head;
+    ring->sq_tail = sq + p->sq_off.tail;
+    ring->sq_array = sq + p->sq_off.array;
+    ring->sq_mask = *(uint32_t *)(sq + p->sq_off.ring_mask);
+    ring->cq_head = cq + p->cq_off.head;
+    ring->cq_tail = cq + p->cq_off.tail;
+    ring->cqes = cq + p->cq_off.cqes;
+    ring->cq_mask = *(uint32_t *)(cq + p->cq_off.ring_mask);
+    ring->early_cqes = g_array_new(false, false, sizeof(struct io_uring_cqe));
+    ring->scratch = g_ptr_array_new_with_free_func(g_free);
+    return ring;
+}
+
+static void io_uring_free(TargetIoUring *ring)
+{
+    munmap(ring->sqes, ring->sq_entries * sizeof(struct io_uring_sqe));
+    if (ring->cq_map != ring->sq_map) {
+        munmap(ring->cq_map, ring->cq_map_size);
+    }
+    munmap(ring->sq_map, ring->sq_map_size);
+    g_array_free(ring->early_cqes, true);
+    g_ptr_array_free(ring->scratch, true);
+    qemu_mutex_destroy(&ring->lock);
+    g_free(ring);
+}
+
+static TargetIoUring *io_uring_get(int fd)
+{
+    TargetIoUring *ring;
+
+    QEMU_LOCK_GUARD(&target_io_uring_lock);
+    ring = g_hash_table_lookup(target_io_urings, GINT_TO_POINTER(fd));
+    if (ring) {
+        ring->refs++;
+    }
+    return ring;
+}
+
+static void io_uring_put(TargetIoUring *ring)
+{
+    bool last;
+
+    qemu_mutex_lock(&target_io_uring_lock);
+    last = --ring->refs == 0;
+    qemu_mutex_unlock(&target_io_uring_lock);
+    if (last) {
+        io_uring_free(ring);
+    }
+}
+
+/* The guest has closed fds @first to @last; drop the io_urings among them. */
+static void io_uring_release(unsigned int first, unsigned int last)
+{
+    GHashTableIter iter;
+    gpointer key, value;
+    GSList *dead = NULL;
+
+    qemu_mutex_lock(&target_io_uring_lock);
+    g_hash_table_iter_init(&iter, target_io_urings);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        unsigned int fd = GPOINTER_TO_INT(key);
+        TargetIoUring *ring = value;
+
+        if (fd >= first && fd <= last) {
+            g_hash_table_iter_remove(&iter);
+            if (--ring->refs == 0) {
+                dead = g_slist_prepend(dead, ring);
+            }
+        }
+    }
+    qemu_mutex_unlock(&target_io_uring_lock);
+    g_slist_free_full(dead, (GDestroyNotify)io_uring_free);
+}
+
+/* The guest has duplicated @oldfd as @newfd; share the io_uring of @oldfd. */
+static void io_uring_dup(int oldfd, int newfd)
+{
+    TargetIoUring *ring;
+
+    if (oldfd == newfd) {
+        return;
+    }
+    io_uring_release(newfd, newfd);
+
+    QEMU_LOCK_GUARD(&target_io_uring_lock);
+    ring = g_hash_table_lookup(target_io_urings, GINT_TO_POINTER(oldfd));
+    if (ring) {
+        ring->refs++;
+        g_hash_table_insert(target_io_urings, GINT_TO_POINTER(newfd), ring);
+    }
+}
+
+static abi_ulong io_uring_sq_size(TargetIoUring *ring)
+{
+    return TARGET_IORING_SQ_ARRAY + ring->sq_entries * sizeof(abi_uint);
+}
+
+static abi_ulong io_uring_cq_size(TargetIoUring *ring)
+{
+    return TARGET_IORING_CQ_CQES +
+           ring->cq_entries * sizeof(struct target_io_uring_cqe);
+}
+
+static abi_ulong io_uring_sqes_size(TargetIoUring *ring)
+{
+    return ring->sq_entries * sizeof(struct target_io_uring_sqe);
+}
+
+static abi_long do_io_uring_setup(unsigned int entries,
+                                  abi_ulong target_params)
+{
+    struct target_io_uring_params *target_p;
+    struct io_uring_params p;
+    TargetIoUring *ring;
+    uint32_t flags;
+    int fd;
+
+    if (!lock_user_struct(VERIFY_WRITE, target_p, target_params, 1)) {
+        return -TARGET_EFAULT;
+    }
+    __get_user(flags, &target_p->flags);
+    if (flags & ~TARGET_IORING_SETUP_FLAGS) {
+        qemu_log_mask(LOG_UNIMP, "Unsupported io_uring_setup flags: 0x%x\n",
+                      flags & ~TARGET_IORING_SETUP_FLAGS);
+        unlock_user_struct(target_p, target_params, 0);
+        return -TARGET_EINVAL;
+    }
+
+    memset(&p, 0, sizeof(p));
+    p.flags = flags;
+    __get_user(p.cq_entries, &target_p->cq_entries);
+    __get_user(p.wq_fd, &target_p->wq_fd);
+    fd = sys_io_uring_setup(entries, &p);
+    if (fd < 0) {
+        unlock_user_struct(target_p, target_params, 0);
+        return get_errno(fd);
+    }
+
+    /*
+     * Converted iovecs and the like are freed once the host has consumed
+     * the SQE, which is only safe if the kernel no longer reads them.
+     */
+    if (!(p.features & IORING_FEAT_SUBMIT_STABLE)) {
+        close(fd);
+        unlock_user_struct(target_p, target_params, 0);
+        return -TARGET_ENOSYS;
+    }
+    ring = io_uring_new(fd, &p);
+    if (!ring) {
+        close(fd);
+        unlock_user_struct(target_p, target_params, 0);
+        return -TARGET_ENOMEM;
+    }
+
+    memset(target_p, 0, sizeof(*target_p));
+    __put_user(p.sq_entries, &target_p->sq_entries);
+    __put_user(p.cq_entries, &target_p->cq_entries);
+    __put_user(flags, &target_p->flags);
+    __put_user(p.features & TARGET_IORING_FEATURES, &target_p->features);
+    __put_user(p.wq_fd, &target_p->wq_fd);
+    __put_user(TARGET_IORING_SQ_HEAD, &target_p->sq_off.head);
+    __put_user(TARGET_IORING_SQ_TAIL, &target_p->sq_off.tail);
+    __put_user(TARGET_IORING_SQ_MASK, &target_p->sq_off.ring_mask);
+    __put_user(TARGET_IORING_SQ_ENTRIES, &target_p->sq_off.ring_entries);
+    __put_user(TARGET_IORING_SQ_FLAGS, &target_p->sq_off.flags);
+    __put_user(TARGET_IORING_SQ_DROPPED, &target_p->sq_off.dropped);
+    __put_user(TARGET_IORING_SQ_ARRAY, &target_p->sq_off.array);
+    __put_user(TARGET_IORING_CQ_HEAD, &target_p->cq_off.head);
+    __put_user(TARGET_IORING_CQ_TAIL, &target_p->cq_off.tail);
+    __put_user(TARGET_IORING_CQ_MASK, &target_p->cq_off.ring_mask);
+    __put_user(TARGET_IORING_CQ_ENTRIES, &target_p->cq_off.ring_entries);
+    __put_user(TARGET_IORING_CQ_OVERFLOW, &target_p->cq_off.overflow);
+    __put_user(TARGET_IORING_CQ_CQES, &target_p->cq_off.cqes);
+    __put_user(TARGET_IORING_CQ_FLAGS, &target_p->cq_off.flags);
+    unlock_user_struct(target_p, target_params, 1);
+
+    fd_trans_unregister(fd);
+    WITH_QEMU_LOCK_GUARD(&target_io_uring_lock) {
+        g_hash_table_insert(target_io_urings, GINT_TO_POINTER(fd), ring);
+    }
+    return fd;
+}
+
+/* Map one of the guest rings of @ring at the io_uring offset @offset. */
+static abi_long do_io_uring_mmap(TargetIoUring *ring, abi_ulong addr,
+                                 abi_ulong len, int prot, int host_flags,
+                                 off_t offset)
+{
+    abi_ulong size, start;
+
+    switch (offset) {
+    case IORING_OFF_SQ_RING:
+        size = io_uring_sq_size(ring);
+        break;
+    case IORING_OFF_CQ_RING:
+        size = io_uring_cq_size(ring);
+        break;
+    case IORING_OFF_SQES:
+        size = io_uring_sqes_size(ring);
+        break;
+    default:
+        return -TARGET_EINVAL;
+    }
+    if (len < size) {
+        return -TARGET_EINVAL;
+    }
+
+    start = target_mmap(addr, len, prot, host_flags | MAP_ANONYMOUS, -1, 0);
+    if (start == -1) {
+        return get_errno(-1);
+    }
+
+    QEMU_LOCK_GUARD(&ring->lock);
+    switch (offset) {
+    case IORING_OFF_SQ_RING:
+        if (put_user_u32(ring->sq_entries - 1, start + TARGET_IORING_SQ_MASK) ||
+            put_user_u32(ring->sq_entries, start + TARGET_IORING_SQ_ENTRIES) ||
+            put_user_u32(TARGET_IORING_SQ_TASKRUN,
+                         start + TARGET_IORING_SQ_FLAGS)) {
+            break;
+        }
+        ring->guest_sq = start;
+        ring->guest_sq_head = 0;
+        ring->guest_dropped = 0;
+        break;
+    case IORING_OFF_CQ_RING:
+        if (put_user_u32(ring->cq_entries - 1, start + TARGET_IORING_CQ_MASK) ||
+            put_user_u32(ring->cq_entries, start + TARGET_IORING_CQ_ENTRIES)) {
+            break;
+        }
+        ring->guest_cq = start;
+        ring->guest_cq_tail = 0;
+        break;
+    case IORING_OFF_SQES:
+        ring->guest_sqes = start;
+        break;
+    }
+    return start;
+}
+
+static bool io_uring_guest_rings_ok(TargetIoUring *ring)
+{
+    return ring->guest_sq && ring->guest_cq && ring->guest_sqes &&
+           access_ok_untagged(VERIFY_WRITE, ring->guest_sq,
+                              io_uring_sq_size(ring)) &&
+           access_ok_untagged(VERIFY_WRITE, ring->guest_cq,
+                              io_uring_cq_size(ring)) &&
+           access_ok_untagged(VERIFY_READ, ring->guest_sqes,
+                              io_uring_sqes_size(ring));
+}
+
+static bool io_uring_op_supported(uint8_t op)
+{
+    switch (op) {
+    case IORING_OP_NOP:
+    case IORING_OP_READV:
+    case IORING_OP_WRITEV:
+    case IORING_OP_FSYNC:
+    case IORING_OP_READ_FIXED:
+    case IORING_OP_WRITE_FIXED:
+    case IORING_OP_POLL_ADD:
+    case IORING_OP_POLL_REMOVE:
+    case IORING_OP_SYNC_FILE_RANGE:
+    case IORING_OP_TIMEOUT:
+    case IORING_OP_TIMEOUT_REMOVE:
+    case IORING_OP_ACCEPT:
+    case IORING_OP_ASYNC_CANCEL:
+    case IORING_OP_LINK_TIMEOUT:
+    case IORING_OP_CONNECT:
+    case IORING_OP_FALLOCATE:
+    case IORING_OP_OPENAT:
+    case IORING_OP_CLOSE:
+    case IORING_OP_READ:
+    case IORING_OP_WRITE:
+    case IORING_OP_SEND:
+    case IORING_OP_RECV:
+    case IORING_OP_SPLICE:
+    case IORING_OP_PROVIDE_BUFFERS:
+    case IORING_OP_REMOVE_BUFFERS:
+    case IORING_OP_TEE:
+    case IORING_OP_SHUTDOWN:
+    case IORING_OP_RENAMEAT:
+    case IORING_OP_UNLINKAT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* Point the SQE at the host address of the guest buffer it names. */
+static abi_long io_uring_buffer(CPUState *cpu, struct io_uring_sqe *sqe,
+                                int type, uint64_t len)
+{
+    if (sqe->flags & IOSQE_BUFFER_SELECT) {
+        return 0;
+    }
+    if (sqe->addr != (abi_ulong)sqe->addr || len != (abi_ulong)len ||
+        !access_ok(cpu, type, sqe->addr, len)) {
+        return -TARGET_EFAULT;
+    }
+    sqe->addr = (uintptr_t)g2h(cpu, sqe->addr);
+    return 0;
+}
+
+static abi_long io_uring_iovec(CPUState *cpu, TargetIoUring *ring,
+                               struct io_uring_sqe *sqe, int type)
+{
+    struct target_iovec *target_vec;
+    abi_ulong target_addr = sqe->addr;
+    abi_ulong count = sqe->len;
+    struct iovec *vec;
+    int i;
+
+    if (count > IOV_MAX) {
+        return -TARGET_EINVAL;
+    }
+    target_vec = lock_user(VERIFY_READ, target_addr,
+                           count * sizeof(struct target_iovec), 1);
+    if (!target_vec) {
+        return -TARGET_EFAULT;
+    }
+    vec = g_new(struct iovec, count);
+    for (i = 0; i < count; i++) {
+        abi_ulong base = tswapal(target_vec[i].iov_base);
+        abi_ulong len = tswapal(target_vec[i].iov_len);
+
+        if (!access_ok(cpu, type, base, len)) {
+            unlock_user(target_vec, target_addr, 0);
+            g_free(vec);
+            return -TARGET_EFAULT;
+        }
+        vec[i].iov_base = g2h(cpu, base);
+        vec[i].iov_len = len;
+    }
+    unlock_user(target_vec, target_addr, 0);
+
+    g_ptr_array_add(ring->scratch, vec);
+    sqe->addr = (uintptr_t)vec;
+    return 0;
+}
+
+static abi_long io_uring_timespec(TargetIoUring *ring, __u64 *field)
+{
+    struct target__kernel_timespec *target_ts;
+    struct __kernel_timespec *ts;
+    abi_ulong target_addr = *field;
+
+    if (!lock_user_struct(VERIFY_READ, target_ts, target_addr, 1)) {
+        return -TARGET_EFAULT;
+    }
+    ts = g_new(struct __kernel_timespec, 1);
+    __get_user(ts->tv_sec, &target_ts->tv_sec);
+    __get_user(ts->tv_nsec, &target_ts->tv_nsec);
+    unlock_user_struct(target_ts, target_addr, 0);
+
+    g_ptr_array_add(ring->scratch, ts);
+    *field = (uintptr_t)ts;
+    return 0;
+}
+
+static abi_long io_uring_path(TargetIoUring *ring, __u64 *field)
+{
+    abi_ulong target_addr = *field;
+    char *p, *host_path;
+
+    p = lock_user_string(target_addr);
+    if (!p) {
+        return -TARGET_EFAULT;
+    }
+    host_path = g_strdup(path(p));
+    unlock_user(p, target_addr, 0);
+
+    g_ptr_array_add(ring->scratch, host_path);
+    *field = (uintptr_t)host_path;
+    return 0;
+}
+
+static abi_long io_uring_sockaddr(TargetIoUring *ring,
+                                  struct io_uring_sqe *sqe)
+{
+    socklen_t addrlen = sqe->off;
+    void *addr;
+    abi_long ret;
+
+    if ((int)addrlen < 0) {
+        return -TARGET_EINVAL;
+    }
+    addr = g_malloc(addrlen + 1);
+    ret = target_to_host_sockaddr(sqe->fd, addr, sqe->addr, addrlen);
+    if (ret) {
+        g_free(addr);
+        return ret;
+    }
+
+    g_ptr_array_add(ring->scratch, addr);
+    sqe->addr = (uintptr_t)addr;
+    return 0;
+}
+
+/* 32-bit poll masks are stored word-swapped on big-endian hosts. */
+static uint32_t io_uring_poll32(uint32_t events)
+{
+    if (TARGET_BIG_ENDIAN) {
+        events = rol32(events, 16);
+    }
+    if (HOST_BIG_ENDIAN) {
+        events = rol32(events, 16);
+    }
+    return events;
+}
+
+/*
+ * Poll bits up to POLLRDBAND are the same on all architectures, but some
+ * give POLLWRNORM, POLLWRBAND, POLLMSG and POLLRDHUP values of their own.
+ * The kernel only reports the events asked for, plus POLLERR, POLLHUP and
+ * POLLNVAL, so poll requests limited to the common bits need no
+ * translation either way.  Others are refused unless the guest and host
+ * both use the generic values.
+ */
+#if defined(TARGET_MIPS) || defined(TARGET_SPARC) || defined(TARGET_ALPHA) || \
+    defined(TARGET_HPPA) || defined(TARGET_M68K) || defined(TARGET_XTENSA)
+#define TARGET_POLL_GENERIC false
+#else
+#define TARGET_POLL_GENERIC true
+#endif
+#define HOST_POLL_GENERIC \
+    (POLLWRNORM == 0x100 && POLLWRBAND == 0x200 && POLLMSG == 0x400 && \
+     POLLRDHUP == 0x2000)
+#define IORING_POLL_COMMON_BITS 0xff
+
+static bool io_uring_poll_ok(uint32_t events)
+{
+    if ((TARGET_POLL_GENERIC && HOST_POLL_GENERIC) ||
+        !(events & ~IORING_POLL_COMMON_BITS)) {
+        return true;
+    }
+    qemu_log_mask(LOG_UNIMP, "Unsupported io_uring poll events: 0x%x\n",
+                  events);
+    return false;
+}
+
+/*
+ * Convert the guest SQE @target into the host SQE @sqe.  Return false if
+ * the SQE was instead completed here, with result @res.
+ */
+static bool io_uring_convert_sqe(CPUArchState *cpu_env, TargetIoUring *ring,
+                                 struct io_uring_sqe *sqe,
+                                 const struct target_io_uring_sqe *target,
+                                 int32_t *res)
+{
+    CPUState *cpu = env_cpu(cpu_env);
+    struct target_io_uring_sqe t = *target;
+    abi_long ret = 0;
+    char *p;
+    int fd;
+
+    if (!io_uring_op_supported(t.opcode)) {
+        qemu_log_mask(LOG_UNIMP, "Unsupported io_uring opcode: %d\n",
+                      t.opcode);
+        *res = -TARGET_EINVAL;
+        return false;
+    }
+
+    /* user_data is opaque and is handed back to the guest as is. */
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = t.opcode;
+    sqe->flags = t.flags;
+    __get_user(sqe->ioprio, &t.ioprio);
+    __get_user(sqe->fd, &t.fd);
+    __get_user(sqe->off, &t.off);
+    __get_user(sqe->addr, &t.addr);
+    __get_user(sqe->len, &t.len);
+    __get_user(sqe->rw_flags, &t.op_flags);
+    sqe->user_data = t.user_data;
+    __get_user(sqe->buf_index, &t.buf_index);
+    __get_user(sqe->personality, &t.personality);
+    __get_user(sqe->splice_fd_in, &t.splice_fd_in);
+
+    switch (sqe->opcode) {
+    case IORING_OP_READV:
+        ret = io_uring_iovec(cpu, ring, sqe, VERIFY_WRITE);
+        break;
+    case IORING_OP_WRITEV:
+        ret = io_uring_iovec(cpu, ring, sqe, VERIFY_READ);
+        break;
+    case IORING_OP_READ:
+    case IORING_OP_READ_FIXED:
+    case IORING_OP_RECV:
+        ret = io_uring_buffer(cpu, sqe, VERIFY_WRITE, sqe->len);
+        break;
+    case IORING_OP_WRITE:
+    case IORING_OP_WRITE_FIXED:
+    case IORING_OP_SEND:
+        ret = io_uring_buffer(cpu, sqe, VERIFY_READ, sqe->len);
+        break;
+    case IORING_OP_PROVIDE_BUFFERS:
+        /* fd is the number of buffers, len the size of each. */
+        ret = io_uring_buffer(cpu, sqe, VERIFY_WRITE,
+                              (uint64_t)(uint32_t)sqe->fd * sqe->len);
+        break;
+    case IORING_OP_POLL_ADD:
+        sqe->poll32_events = io_uring_poll32(sqe->poll32_events);
+        if (!io_uring_poll_ok(sqe->poll32_events)) {
+            ret = -TARGET_EINVAL;
+        }
+        break;
+    case IORING_OP_POLL_REMOVE:
+        /* addr and off hold the user_data of poll requests. */
+        sqe->addr = t.addr;
+        sqe->off = t.off;
+        sqe->poll32_events = io_uring_poll32(sqe->poll32_events);
+        if (!io_uring_poll_ok(sqe->poll32_events)) {
+            ret = -TARGET_EINVAL;
+        }
+        break;
+    case IORING_OP_ASYNC_CANCEL:
+        sqe->addr = t.addr;
+        break;
+    case IORING_OP_TIMEOUT:
+    case IORING_OP_LINK_TIMEOUT:
+        ret = io_uring_timespec(ring, &sqe->addr);
+        break;
+    case IORING_OP_TIMEOUT_REMOVE:
+        sqe->addr = t.addr;
+        if (sqe->timeout_flags & IORING_TIMEOUT_UPDATE) {
+            ret = io_uring_timespec(ring, &sqe->off);
+        }
+        break;
+    case IORING_OP_ACCEPT:
+        if (sqe->addr || sqe->off) {
+            qemu_log_mask(LOG_UNIMP,
+                          "Unsupported io_uring accept with address\n");
+            ret = -TARGET_EINVAL;
+            break;
+        }
+        if (sqe->accept_flags &
+            ~(TARGET_SOCK_CLOEXEC | TARGET_SOCK_NONBLOCK)) {
+            ret = -TARGET_EINVAL;
+            break;
+        }
+        sqe->accept_flags =
+            (sqe->accept_flags & TARGET_SOCK_NONBLOCK ? SOCK_NONBLOCK : 0) |
+            (sqe->accept_flags & TARGET_SOCK_CLOEXEC ? SOCK_CLOEXEC : 0);
+        break;
+    case IORING_OP_CONNECT:
+        ret = io_uring_sockaddr(ring, sqe);
+        break;
+    case IORING_OP_OPENAT:
+        sqe->open_flags = target_to_host_bitmask(sqe->open_flags,
+                                                 fcntl_flags_tbl);
+        p = lock_user_string(sqe->addr);
+        if (!p) {
+            ret = -TARGET_EFAULT;
+            break;
+        }
+        fd = maybe_do_fake_open(cpu_env, sqe->fd, p, sqe->open_flags,
+                                sqe->len, 0, false);
+        unlock_user(p, sqe->addr, 0);
+        if (fd > -2) {
+            ret = get_errno(fd);
+            fd_trans_unregister(ret);
+            *res = ret;
+            return false;
+        }
+        ret = io_uring_path(ring, &sqe->addr);
+        break;
+    case IORING_OP_UNLINKAT:
+        ret = io_uring_path(ring, &sqe->addr);
+        break;
+    case IORING_OP_RENAMEAT:
+        ret = io_uring_path(ring, &sqe->addr);
+        if (!ret) {
+            ret = io_uring_path(ring, &sqe->addr2);
+        }
+        break;
+    case IORING_OP_CLOSE:
+        fd_trans_unregister(sqe->fd);
+        io_uring_release(sqe->fd, sqe->fd);
+        break;
+    default:
+        break;
+    }
+
+    if (ret) {
+        *res = ret;
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Move newly queued guest SQEs to the host ring and submit everything
+ * the host has not consumed yet.  Return the number of guest SQEs
+ * consumed.
+ */
+static abi_long io_uring_submit_locked(CPUArchState *cpu_env, int fd,
+                                       TargetIoUring *ring,
+                                       unsigned int to_submit)
+{
+    uint32_t *guest_tail = g2h_untagged(ring->guest_sq + TARGET_IORING_SQ_TAIL);
+    abi_uint *guest_array = g2h_untagged(ring->guest_sq +
+                                         TARGET_IORING_SQ_ARRAY);
+    struct target_io_uring_sqe *guest_sqes = g2h_untagged(ring->guest_sqes);
+    uint32_t guest_mask = ring->sq_entries - 1;
+    uint32_t head = ring->guest_sq_head;
+    uint32_t host_tail = *ring->sq_tail;
+    uint32_t n, i, pending;
+    int ret;
+
+    n = tswap32(qatomic_load_acquire(guest_tail)) - head;
+    n = MIN(n, to_submit);
+    n = MIN(n, ring->sq_entries -
+               (host_tail - qatomic_load_acquire(ring->sq_head)));
+
+    for (i = 0; i < n; i++) {
+        uint32_t idx = tswap32(guest_array[head++ & guest_mask]);
+        uint32_t slot = host_tail & ring->sq_mask;
+        struct io_uring_cqe cqe;
+
+        if (idx >= ring->sq_entries) {
+            ring->guest_dropped++;
+            continue;
+        }
+        if (!io_uring_convert_sqe(cpu_env, ring, &ring->sqes[slot],
+                                  &guest_sqes[idx], &cqe.res)) {
+            /* Like the kernel, stop submitting after a failed SQE. */
+            cqe.user_data = guest_sqes[idx].user_data;
+            cqe.flags = 0;
+            g_array_append_val(ring->early_cqes, cqe);
+            i++;
+            break;
+        }
+        ring->sq_array[slot] = slot;
+        host_tail++;
+    }
+
+    qatomic_store_release(ring->sq_tail, host_tail);
+    qatomic_store_release((uint32_t *)g2h_untagged(ring->guest_sq +
+                                                   TARGET_IORING_SQ_HEAD),
+                          tswap32(head));
+    qatomic_set((uint32_t *)g2h_untagged(ring->guest_sq +
+                                         TARGET_IORING_SQ_DROPPED),
+                tswap32(ring->guest_dropped));
+    ring->guest_sq_head = head;
+
+    pending = host_tail - qatomic_load_acquire(ring->sq_head);
+    if (pending) {
+        ret = sys_io_uring_enter(fd, pending, 0, 0, NULL, 0);
+        if (ret < 0 && i == 0) {
+            return get_errno(ret);
+        }
+    }
+    if (qatomic_load_acquire(ring->sq_head) == host_tail) {
+        g_ptr_array_set_size(ring->scratch, 0);
+    }
+    return i;
+}
+
+/*
+ * Move completions to the guest ring, as far as it has room.  Return the
+ * number of completions the guest has not consumed yet.
+ */
+static uint32_t io_uring_reap_locked(TargetIoUring *ring)
+{
+    uint32_t *guest_head = g2h_untagged(ring->guest_cq + TARGET_IORING_CQ_HEAD);
+    uint32_t *guest_tail = g2h_untagged(ring->guest_cq + TARGET_IORING_CQ_TAIL);
+    struct target_io_uring_cqe *guest_cqes =
+        g2h_untagged(ring->guest_cq + TARGET_IORING_CQ_CQES);
+    uint32_t guest_mask = ring->cq_entries - 1;
+    uint32_t head = tswap32(qatomic_load_acquire(guest_head));
+    uint32_t tail = ring->guest_cq_tail;
+    uint32_t host_head = *ring->cq_head;
+    uint32_t host_tail = qatomic_load_acquire(ring->cq_tail);
+    uint32_t sq_flags = TARGET_IORING_SQ_TASKRUN;
+    guint i;
+
+    for (i = 0; i < ring->early_cqes->len &&
+                tail - head < ring->cq_entries; i++) {
+        struct io_uring_cqe *cqe =
+            &g_array_index(ring->early_cqes, struct io_uring_cqe, i);
+        struct target_io_uring_cqe *target = &guest_cqes[tail++ & guest_mask];
+
+        target->user_data = cqe->user_data;
+        __put_user(cqe->res, &target->res);
+        __put_user(cqe->flags, &target->flags);
+    }
+    g_array_remove_range(ring->early_cqes, 0, i);
+
+    while (host_head != host_tail && tail - head < ring->cq_entries) {
+        struct io_uring_cqe *cqe = &ring->cqes[host_head++ & ring->cq_mask];
+        struct target_io_uring_cqe *target = &guest_cqes[tail++ & guest_mask];
+        int32_t res = cqe->res;
+
+        if (res < 0) {
+            res = -host_to_target_errno(-res);
+        }
+        target->user_data = cqe->user_data;
+        __put_user(res, &target->res);
+        __put_user(cqe->flags, &target->flags);
+    }
+    qatomic_store_release(ring->cq_head, host_head);
+    qatomic_store_release(guest_tail, tswap32(tail));
+    ring->guest_cq_tail = tail;
+
+    if (host_head != host_tail || ring->early_cqes->len) {
+        sq_flags |= TARGET_IORING_SQ_CQ_OVERFLOW;
+    }
+    qatomic_set((uint32_t *)g2h_untagged(ring->guest_sq +
+                                         TARGET_IORING_SQ_FLAGS),
+                tswap32(sq_flags));
+    return tail - head;
+}
+
+static abi_long do_io_uring_enter(CPUArchState *cpu_env, int fd,
+                                  unsigned int to_submit,
+                                  unsigned int min_complete,
+                                  unsigned int flags, abi_ulong target_sig,
+                                  abi_ulong sigsize)
+{
+    TargetIoUring *ring;
+    abi_long ret = 0, submitted = 0;
+    uint32_t ready = 0;
+
+    /* Without SQPOLL there is no thread to wake up. */
+    if (flags & ~(IORING_ENTER_GETEVENTS | IORING_ENTER_SQ_WAKEUP)) {
+        return -TARGET_EINVAL;
+    }
+    ring = io_uring_get(fd);
+    if (!ring) {
+        return -TARGET_EOPNOTSUPP;
+    }
+
+    WITH_QEMU_LOCK_GUARD(&ring->lock) {
+        if (!io_uring_guest_rings_ok(ring)) {
+            ret = -TARGET_EFAULT;
+            break;
+        }
+        submitted = io_uring_submit_locked(cpu_env, fd, ring, to_submit);
+        ready = io_uring_reap_locked(ring);
+    }
+
+    if (!ret && submitted >= 0 &&
+        (flags & IORING_ENTER_GETEVENTS) && ready < min_complete) {
+        sigset_t *set = NULL;
+
+        if (target_sig) {
+            ret = process_sigsuspend_mask(&set, target_sig, sigsize);
+        }
+        if (!ret) {
+            ret = get_errno(safe_io_uring_enter(fd, 0,
+                                                min_complete - ready,
+                                                IORING_ENTER_GETEVENTS, set,
+                                                set ? SIGSET_T_SIZE : 0));
+            if (set) {
+                finish_sigsuspend_mask(ret);
+            }
+        }
+        WITH_QEMU_LOCK_GUARD(&ring->lock) {
+            if (io_uring_guest_rings_ok(ring)) {
+                io_uring_reap_locked(ring);
+            }
+        }
+    }
+
+    io_uring_put(ring);
+    if (submitted) {
+        return submitted;
+    }
+    return ret < 0 ? ret : 0;
+}
+
+static abi_long do_io_uring_register(CPUArchState *cpu_env, int fd,
+                                     unsigned int opcode,
+                                     abi_ulong target_arg,
+                                     unsigned int nr_args)
+{
+    CPUState *cpu = env_cpu(cpu_env);
+    abi_long ret;
+    int i;
+
+    switch (opcode) {
+    case IORING_UNREGISTER_BUFFERS:
+    case IORING_UNREGISTER_FILES:
+    case IORING_UNREGISTER_EVENTFD:
+        return get_errno(sys_io_uring_register(fd, opcode, NULL, nr_args));
+
+    case IORING_REGISTER_EVENTFD:
+    case IORING_REGISTER_EVENTFD_ASYNC:
+    {
+        int32_t efd;
+
+        if (get_user_s32(efd, target_arg)) {
+            return -TARGET_EFAULT;
+        }
+        return get_errno(sys_io_uring_register(fd, opcode, &efd, nr_args));
+    }
+
+    case IORING_REGISTER_FILES:
+    {
+        g_autofree int32_t *fds = NULL;
+        abi_int *target_fds;
+
+        if (nr_args > INT_MAX / sizeof(abi_int)) {
+            return -TARGET_EINVAL;
+        }
+        target_fds = lock_user(VERIFY_READ, target_arg,
+                               nr_args * sizeof(abi_int), 1);
+        if (!target_fds) {
+            return -TARGET_EFAULT;
+        }
+        fds = g_new(int32_t, nr_args);
+        for (i = 0; i < nr_args; i++) {
+            __get_user(fds[i], &target_fds[i]);
+        }
+        unlock_user(target_fds, target_arg, 0);
+        return get_errno(sys_io_uring_register(fd, opcode, fds, nr_args));
+    }
+
+    case IORING_REGISTER_BUFFERS:
+    {
+        g_autofree struct iovec *vec = NULL;
+        struct target_iovec *target_vec;
+
+        if (nr_args > TARGET_IORING_MAX_REG_BUFFERS) {
+            return -TARGET_EINVAL;
+        }
+        target_vec = lock_user(VERIFY_READ, target_arg,
+                               nr_args * sizeof(struct target_iovec), 1);
+        if (!target_vec) {
+            return -TARGET_EFAULT;
+        }
+        vec = g_new(struct iovec, nr_args);
+        for (i = 0; i < nr_args; i++) {
+            abi_ulong base = tswapal(target_vec[i].iov_base);
+            abi_ulong len = tswapal(target_vec[i].iov_len);
+
+            if (!access_ok(cpu, VERIFY_WRITE, base, len)) {
+                unlock_user(target_vec, target_arg, 0);
+                return -TARGET_EFAULT;
+            }
+            vec[i].iov_base = g2h(cpu, base);
+            vec[i].iov_len = len;
+        }
+        unlock_user(target_vec, target_arg, 0);
+        return get_errno(sys_io_uring_register(fd, opcode, vec, nr_args));
+    }
+
+    case IORING_REGISTER_PROBE:
+    {
+        g_autofree struct io_uring_probe *probe = NULL;
+        struct target_io_uring_probe *target_probe;
+        size_t size;
+
+        if (nr_args > 256) {
+            nr_args = 256;
+        }
+        size = sizeof(*target_probe) + nr_args * sizeof(target_probe->ops[0]);
+        probe = g_malloc0(sizeof(*probe) + nr_args * sizeof(probe->ops[0]));
+        ret = get_errno(sys_io_uring_register(fd, opcode, probe, nr_args));
+        if (is_error(ret)) {
+            return ret;
+        }
+        target_probe = lock_user(VERIFY_WRITE, target_arg, size, 0);
+        if (!target_probe) {
+            return -TARGET_EFAULT;
+        }
+        memset(target_probe, 0, size);
+        target_probe->last_op = probe->last_op;
+        target_probe->ops_len = probe->ops_len;
+        for (i = 0; i < nr_args; i++) {
+            uint16_t op_flags = probe->ops[i].flags;
+
+            /* Only advertise the opcodes that can be converted. */
+            if (!io_uring_op_supported(probe->ops[i].op)) {
+                op_flags &= ~IO_URING_OP_SUPPORTED;
+            }
+            target_probe->ops[i].op = probe->ops[i].op;
+            __put_user(op_flags, &target_probe->ops[i].flags);
+        }
+        unlock_user(target_probe, target_arg, size);
+        return ret;
+    }
+
+    default:
+        qemu_log_mask(LOG_UNIMP, "Unsupported io_uring_register opcode: %u\n",
+                      opcode);
+        return -TARGET_EINVAL;
+    }
+}
+#endif /* EMULATE_IO_URING */
+
 /* If the host does not provide these bits, they may be safely discarded. */
 #ifndef MAP_SYNC
 #define MAP_SYNC 0
@@ -6170,6 +7238,18 @@ static abi_long do_mmap(abi_ulong addr, abi_ulong len, int prot,
     }
     host_flags |= target_to_host_bitmask(target_flags, mmap_flags_tbl);
 
+#ifdef EMULATE_IO_URING
+    if (!(host_flags & MAP_ANONYMOUS)) {
+        TargetIoUring *ring = io_uring_get(fd);
+
+        if (ring) {
+            abi_long ret = do_io_uring_mmap(ring, addr, len, prot,
+                                            host_flags, offset);
+            io_uring_put(ring);
+            return ret;
+        }
+    }
+#endif
     return get_errno(target_mmap(addr, len, prot, host_flags, fd, offset));
 }
 
@@ -7548,6 +8628,18 @@ static abi_long do_fcntl(int fd, int cmd, abi_ulong arg)
         ret = get_errno(safe_fcntl(fd, host_cmd, arg));
         break;
 
+    case TARGET_F_DUPFD:
+#ifdef F_DUPFD_CLOEXEC
+    case TARGET_F_DUPFD_CLOEXEC:
+#endif
+        ret = get_errno(safe_fcntl(fd, host_cmd, arg));
+#ifdef EMULATE_IO_URING
+        if (ret >= 0) {
+            io_uring_dup(fd, ret);
+        }
+#endif
+        break;
+
     default:
         ret = get_errno(safe_fcntl(fd, cmd, arg));
         break;
@@ -7680,6 +8772,9 @@ void syscall_init(void)
     int size;
 
     thunk_init(STRUCT_MAX);
+#ifdef EMULATE_IO_URING
+    io_uring_init();
+#endif
 
 #define STRUCT(name, ...) thunk_register_struct(STRUCT_ ## name, #name, struct_ ## name ## _def);
 #define STRUCT_SPECIAL(name) thunk_register_struct_direct(STRUCT_ ## name, #name, &struct_ ## name ## _def);
@@ -9902,6 +10997,9 @@ static abi_long do_syscall1(CPUArchState *cpu_env, int num, abi_long arg1,
 #endif
     case TARGET_NR_close:
         fd_trans_unregister(arg1);
+#ifdef EMULATE_IO_URING
+        io_uring_release(arg1, arg1);
+#endif
         return get_errno(close(arg1));
 #if defined(__NR_close_range) && defined(TARGET_NR_close_range)
     case TARGET_NR_close_range:
@@ -9912,6 +11010,9 @@ static abi_long do_syscall1(CPUArchState *cpu_env, int num, abi_long arg1,
             for (fd = arg1; fd < maxfd; fd++) {
                 fd_trans_unregister(fd);
             }
+#ifdef EMULATE_IO_URING
+            io_uring_release(arg1, arg2);
+#endif
         }
         return ret;
 #endif
@@ -10396,6 +11497,9 @@ static abi_long do_syscall1(CPUArchState *cpu_env, int num, abi_long arg1,
         ret = get_errno(dup(arg1));
         if (ret >= 0) {
             fd_trans_dup(arg1, ret);
+#ifdef EMULATE_IO_URING
+            io_uring_dup(arg1, ret);
+#endif
         }
         return ret;
 #ifdef TARGET_NR_pipe
@@ -10465,6 +11569,9 @@ static abi_long do_syscall1(CPUArchState *cpu_env, int num, abi_long arg1,
         ret = get_errno(dup2(arg1, arg2));
         if (ret >= 0) {
             fd_trans_dup(arg1, arg2);
+#ifdef EMULATE_IO_URING
+            io_uring_dup(arg1, arg2);
+#endif
         }
         return ret;
 #endif
@@ -10480,6 +11587,9 @@ static abi_long do_syscall1(CPUArchState *cpu_env, int num, abi_long arg1,
         ret = get_errno(dup3(arg1, arg2, host_flags));
         if (ret >= 0) {
             fd_trans_dup(arg1, arg2);
+#ifdef EMULATE_IO_URING
+            io_uring_dup(arg1, arg2);
+#endif
         }
         return ret;
     }
@@ -14028,6 +15138,15 @@ static abi_long do_syscall1(CPUArchState *cpu_env, int num, abi_long arg1,
         return ret;
     }
 
+#ifdef EMULATE_IO_URING
+    case TARGET_NR_io_uring_setup:
+        return do_io_uring_setup(arg1, arg2);
+    case TARGET_NR_io_uring_enter:
+        return do_io_uring_enter(cpu_env, arg1, arg2, arg3, arg4, arg5, arg6);
+    case TARGET_NR_io_uring_register:
+        return do_io_uring_register(cpu_env, arg1, arg2, arg3, arg4);
+#endif
+
 #ifdef TARGET_NR_prlimit64
     case TARGET_NR_prlimit64:
     {
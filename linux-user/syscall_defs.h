@@ -2780,6 +2780,82 @@ struct target_open_how_ver0 {
 #ifndef RESOLVE_IN_ROOT
 #define RESOLVE_IN_ROOT         0x10
 #endif
+
+/* io_uring */
+struct target_io_sqring_offsets {
+    abi_uint head;
+    abi_uint tail;
+    abi_uint ring_mask;
+    abi_uint ring_entries;
+    abi_uint flags;
+    abi_uint dropped;
+    abi_uint array;
+    abi_uint resv1;
+    abi_ullong user_addr;
+};
+
+struct target_io_cqring_offsets {
+    abi_uint head;
+    abi_uint tail;
+    abi_uint ring_mask;
+    abi_uint ring_entries;
+    abi_uint overflow;
+    abi_uint cqes;
+    abi_uint flags;
+    abi_uint resv1;
+    abi_ullong user_addr;
+};
+
+struct target_io_uring_params {
+    abi_uint sq_entries;
+    abi_uint cq_entries;
+    abi_uint flags;
+    abi_uint sq_thread_cpu;
+    abi_uint sq_thread_idle;
+    abi_uint features;
+    abi_uint wq_fd;
+    abi_uint resv[3];
+    struct target_io_sqring_offsets sq_off;
+    struct target_io_cqring_offsets cq_off;
+};
+
+struct target_io_uring_sqe {
+    uint8_t opcode;
+    uint8_t flags;
+    abi_ushort ioprio;
+    abi_int fd;
+    abi_ullong off;
+    abi_ullong addr;
+    abi_uint len;
+    abi_uint op_flags;
+    abi_ullong user_data;
+    abi_ushort buf_index;
+    abi_ushort personality;
+    abi_int splice_fd_in;
+    abi_ullong pad2[2];
+};
+
+struct target_io_uring_cqe {
+    abi_ullong user_data;
+    abi_int res;
+    abi_uint flags;
+};
+
+struct target_io_uring_probe_op {
+    uint8_t op;
+    uint8_t resv;
+    abi_ushort flags;
+    abi_uint resv2;
+};
+
+struct target_io_uring_probe {
+    uint8_t last_op;
+    uint8_t ops_len;
+    abi_ushort resv;
+    abi_uint resv2[3];
+    struct target_io_uring_probe_op ops[];
+};
+
 #if (defined(TARGET_I386) && defined(TARGET_ABI32)) || \
     (defined(TARGET_ARM) && defined(TARGET_ABI32)) || \
     defined(TARGET_M68K) || defined(TARGET_MICROBLAZE) || \
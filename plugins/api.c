@@ -195,6 +195,25 @@ void qemu_plugin_register_vcpu_mem_inline_per_vcpu(
     plugin_register_inline_op_on_entry(&insn->mem_cbs, rw, op, entry, imm);
 }
 
+void qemu_plugin_register_vcpu_insn_exec_record(
+    struct qemu_plugin_insn *insn,
+    struct qemu_plugin_record_buffer *buf,
+    uint64_t data)
+{
+    if (!tb_is_mem_only()) {
+        plugin_register_record_op(&insn->insn_cbs, 0, buf, data, insn->vaddr);
+    }
+}
+
+void qemu_plugin_register_vcpu_mem_record(
+    struct qemu_plugin_insn *insn,
+    struct qemu_plugin_record_buffer *buf,
+    enum qemu_plugin_mem_rw rw,
+    uint64_t data)
+{
+    plugin_register_record_op(&insn->mem_cbs, rw, buf, data, 0);
+}
+
 void qemu_plugin_register_vcpu_tb_trans_cb(qemu_plugin_id_t id,
                                            qemu_plugin_vcpu_tb_trans_cb_t cb,
                                            void *userdata)
@@ -652,6 +671,25 @@ void qemu_plugin_scoreboard_free(struct qemu_plugin_scoreboard *score)
     plugin_scoreboard_free(score);
 }
 
+struct qemu_plugin_record_buffer *
+qemu_plugin_record_buffer_new(size_t size, qemu_plugin_vcpu_records_cb_t cb,
+                              void *userdata)
+{
+    return plugin_record_buffer_new(size, cb, userdata);
+}
+
+void qemu_plugin_record_buffer_free(struct qemu_plugin_record_buffer *buf)
+{
+    plugin_record_buffer_free(buf);
+}
+
+void qemu_plugin_record_buffer_flush(struct qemu_plugin_record_buffer *buf,
+                                     unsigned int vcpu_index)
+{
+    g_assert(vcpu_index < qemu_plugin_num_vcpus());
+    plugin_record_buffer_flush(buf, vcpu_index);
+}
+
 void *qemu_plugin_scoreboard_find(struct qemu_plugin_scoreboard *score,
                                   unsigned int vcpu_index)
 {
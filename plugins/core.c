@@ -367,6 +367,22 @@ void plugin_register_inline_op_on_entry(GArray **arr,
     dyn_cb->inline_insn = inline_cb;
 }
 
+void plugin_register_record_op(GArray **arr,
+                               enum qemu_plugin_mem_rw rw,
+                               struct qemu_plugin_record_buffer *buf,
+                               uint64_t data, uint64_t vaddr)
+{
+    struct qemu_plugin_dyn_cb *dyn_cb;
+
+    struct qemu_plugin_record_cb record_cb = { .rw = rw,
+                                               .buf = buf,
+                                               .data = data,
+                                               .vaddr = vaddr };
+    dyn_cb = plugin_get_dyn_cb(arr);
+    dyn_cb->type = PLUGIN_CB_INLINE_RECORD;
+    dyn_cb->record = record_cb;
+}
+
 void plugin_register_dyn_cb__udata(GArray **arr,
                                    qemu_plugin_vcpu_udata_cb_t cb,
                                    enum qemu_plugin_cb_flags flags,
@@ -712,6 +728,58 @@ void exec_inline_op(enum plugin_dyn_cb_type type,
     }
 }
 
+static struct qemu_plugin_record_vcpu *
+plugin_record_vcpu(struct qemu_plugin_record_buffer *buf, int cpu_index)
+{
+    GArray *arr = buf->score->data;
+
+    return (struct qemu_plugin_record_vcpu *)
+        (arr->data + cpu_index * g_array_get_element_size(arr));
+}
+
+/*
+ * The C version of gen_record_reserve and gen_record_cb, for accesses
+ * made from helpers or whose room could not be made at insn start.
+ */
+static void exec_record_op(struct qemu_plugin_record_buffer *buf,
+                           int cpu_index, uint64_t data, uint64_t vaddr,
+                           qemu_plugin_meminfo_t info)
+{
+    struct qemu_plugin_record_vcpu *v = plugin_record_vcpu(buf, cpu_index);
+    qemu_plugin_record *r;
+
+    if (v->n == buf->size) {
+        plugin_record_buffer_flush(buf, cpu_index);
+    }
+    r = &v->records[v->n++];
+    r->data = data;
+    r->vaddr = vaddr;
+    r->info = info;
+}
+
+QEMU_DISABLE_CFI
+void plugin_record_buffer_flush(struct qemu_plugin_record_buffer *buf,
+                                unsigned int vcpu_index)
+{
+    struct qemu_plugin_record_vcpu *v = plugin_record_vcpu(buf, vcpu_index);
+
+    if (v->n) {
+        buf->cb(vcpu_index, v->records, v->n, buf->userp);
+        v->n = 0;
+    }
+}
+
+void qemu_plugin_vcpu_record_flush(unsigned int vcpu_index, void *buf)
+{
+    plugin_record_buffer_flush(buf, vcpu_index);
+}
+
+void qemu_plugin_vcpu_record(unsigned int vcpu_index, void *buf,
+                             uint64_t data, uint64_t vaddr, uint32_t info)
+{
+    exec_record_op(buf, vcpu_index, data, vaddr, info);
+}
+
 QEMU_DISABLE_CFI
 void qemu_plugin_vcpu_mem_cb(CPUState *cpu, uint64_t vaddr,
                              uint64_t value_low,
@@ -750,6 +818,13 @@ void qemu_plugin_vcpu_mem_cb(CPUState *cpu, uint64_t vaddr,
                 exec_inline_op(cb->type, &cb->inline_insn, cpu->cpu_index);
             }
             break;
+        case PLUGIN_CB_INLINE_RECORD:
+            if (rw & cb->record.rw) {
+                exec_record_op(cb->record.buf, cpu->cpu_index,
+                               cb->record.data, vaddr,
+                               make_plugin_meminfo(oi, rw));
+            }
+            break;
         default:
             g_assert_not_reached();
         }
@@ -883,6 +958,28 @@ void plugin_scoreboard_free(struct qemu_plugin_scoreboard *score)
     g_free(score);
 }
 
+struct qemu_plugin_record_buffer *
+plugin_record_buffer_new(size_t size, qemu_plugin_vcpu_records_cb_t cb,
+                         void *udata)
+{
+    struct qemu_plugin_record_buffer *buf =
+        g_new0(struct qemu_plugin_record_buffer, 1);
+
+    g_assert(size > 0);
+    buf->size = size;
+    buf->cb = cb;
+    buf->userp = udata;
+    buf->score = plugin_scoreboard_new(sizeof(struct qemu_plugin_record_vcpu) +
+                                       size * sizeof(qemu_plugin_record));
+    return buf;
+}
+
+void plugin_record_buffer_free(struct qemu_plugin_record_buffer *buf)
+{
+    plugin_scoreboard_free(buf->score);
+    g_free(buf);
+}
+
 enum qemu_plugin_cb_flags tcg_call_to_qemu_plugin_cb_flags(int flags)
 {
     if (flags & TCG_CALL_NO_RWG) {
@@ -75,6 +75,11 @@ void plugin_register_inline_op_on_entry(GArray **arr,
                                         qemu_plugin_u64 entry,
                                         uint64_t imm);
 
+void plugin_register_record_op(GArray **arr,
+                               enum qemu_plugin_mem_rw rw,
+                               struct qemu_plugin_record_buffer *buf,
+                               uint64_t data, uint64_t vaddr);
+
 void plugin_reset_uninstall(qemu_plugin_id_t id,
                             qemu_plugin_udata_cb_t cb,
                             void *userdata,
@@ -120,6 +125,15 @@ struct qemu_plugin_scoreboard *plugin_scoreboard_new(size_t element_size);
 
 void plugin_scoreboard_free(struct qemu_plugin_scoreboard *score);
 
+struct qemu_plugin_record_buffer *
+plugin_record_buffer_new(size_t size, qemu_plugin_vcpu_records_cb_t cb,
+                         void *udata);
+
+void plugin_record_buffer_free(struct qemu_plugin_record_buffer *buf);
+
+void plugin_record_buffer_flush(struct qemu_plugin_record_buffer *buf,
+                                unsigned int vcpu_index);
+
 /**
  * qemu_plugin_fillin_mode_info() - populate mode specific info
  * info: pointer to qemu_info_t structure
@@ -240,6 +240,8 @@ DEF("accel", HAS_ARG, QEMU_OPTION_accel,
     "                one-insn-per-tb=on|off (one guest instruction per TCG translation block)\n"
     "                split-wx=on|off (enable TCG split w^x mapping)\n"
     "                tb-size=n (TCG translation block cache size)\n"
+    "                tier-threshold=n (retranslate TCG blocks executed n times, default 0, disabled)\n"
+    "                jmp-cache-size=n,jmp-cache-ways=w (TCG per-vCPU jump cache geometry, default 4096,1)\n"
     "                dirty-ring-size=n (KVM dirty ring GFN count, default 0)\n"
     "                eager-split-size=n (KVM Eager Page Split chunk size, default 0, disabled. ARM only)\n"
     "                notify-vmexit=run|internal-error|disable,notify-window=n (enable notify VM exit and set notify window, x86 only)\n"
@@ -283,6 +285,23 @@ SRST
     ``tb-size=n``
         Controls the size (in MiB) of the TCG translation block cache.
 
+    ``tier-threshold=n``
+        Counts the executions of each TCG translation block, and
+        retranslates a block into a longer trace once it has run ``n``
+        times. Traces follow direct jumps and predict forward conditional
+        branches as not taken, on targets that support it. The default
+        of 0 disables counting. The counts can be inspected with
+        ``info jit-hotness``.
+
+    ``jmp-cache-size=n,jmp-cache-ways=w``
+        Sets the geometry of the per-vCPU cache that maps a guest PC
+        to its translation block, before falling back to the global hash
+        table. ``n`` is the total number of entries, a power of two from
+        64 to 65536 (default 4096). ``w`` is the associativity: 1, 2 or 4
+        (default 1). Guests with many hot indirect branches may benefit
+        from a larger or 2-way or 4-way cache. The hit rates are shown by
+        ``info jit``.
+
     ``thread=single|multi``
         Controls number of TCG threads. When the TCG is multi-threaded
         there will be one thread per vCPU therefore taking advantage of
@@ -2443,6 +2443,7 @@ static bool get_phys_addr_lpae(CPUARMState *env, S1Translate *ptw,
 
     result->f.phys_addr = descaddr;
     result->f.lg_page_size = ctz64(page_size);
+    result->f.lg_map_size = result->f.lg_page_size;
     return true;
 
  do_translation_fault:
@@ -3621,7 +3622,7 @@ static bool get_phys_addr_twostage(CPUARMState *env, S1Translate *ptw,
                                    ARMMMUFaultInfo *fi)
 {
     hwaddr ipa;
-    int s1_prot, s1_lgpgsz;
+    int s1_prot, s1_lgpgsz, s1_lgmapsz;
     ARMSecuritySpace in_space = ptw->in_space;
     bool ret, ipa_secure, s1_guarded;
     ARMCacheAttrs cacheattrs1;
@@ -3651,6 +3652,7 @@ static bool get_phys_addr_twostage(CPUARMState *env, S1Translate *ptw,
      */
     s1_prot = result->f.prot;
     s1_lgpgsz = result->f.lg_page_size;
+    s1_lgmapsz = result->f.lg_map_size;
     s1_guarded = result->f.extra.arm.guarded;
     cacheattrs1 = result->cacheattrs;
     memset(result, 0, sizeof(*result));
@@ -3672,11 +3674,10 @@ static bool get_phys_addr_twostage(CPUARMState *env, S1Translate *ptw,
      * this means "don't put this in the TLB"; in this case, return a
      * result with lg_page_size == 0 to achieve that. Otherwise,
      * use the maximum of the S1 & S2 page size, so that invalidation
-     * of pages > TARGET_PAGE_SIZE works correctly. (This works even though
-     * we know the combined result permissions etc only cover the minimum
-     * of the S1 and S2 page size, because we know that the common TLB code
-     * never actually creates TLB entries bigger than TARGET_PAGE_SIZE,
-     * and passing a larger page size value only affects invalidations.)
+     * of pages > TARGET_PAGE_SIZE works correctly. (The combined result
+     * permissions etc only cover the minimum of the S1 and S2 page size;
+     * that is what we report in lg_map_size, which the common TLB code
+     * uses to fill the rest of the page without another walk.)
      */
     if (result->f.lg_page_size < TARGET_PAGE_BITS ||
         s1_lgpgsz < TARGET_PAGE_BITS) {
@@ -3684,6 +3685,8 @@ static bool get_phys_addr_twostage(CPUARMState *env, S1Translate *ptw,
     } else if (result->f.lg_page_size < s1_lgpgsz) {
         result->f.lg_page_size = s1_lgpgsz;
     }
+    /* The combined translation is only the same across the smaller. */
+    result->f.lg_map_size = MIN(result->f.lg_map_size, s1_lgmapsz);
 
     /* Combine the S1 and S2 cache attributes. */
     hcr = arm_hcr_el2_eff_secstate(env, in_space);
@@ -3890,6 +3893,8 @@ static bool get_phys_addr_gpc(CPUARMState *env, S1Translate *ptw,
             fi->type = ARMFault_GPCFOnOutput;
             return false;
         }
+        /* Each granule of the page must be checked separately. */
+        result->f.lg_map_size = 0;
     }
 
     return true;
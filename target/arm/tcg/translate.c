@@ -71,6 +71,10 @@ void arm_translate_init(void)
     cpu_NF = tcg_global_mem_new_i32(tcg_env, offsetof(CPUARMState, NF), "NF");
     cpu_VF = tcg_global_mem_new_i32(tcg_env, offsetof(CPUARMState, VF), "VF");
     cpu_ZF = tcg_global_mem_new_i32(tcg_env, offsetof(CPUARMState, ZF), "ZF");
+    tcg_global_set_flag_i32(cpu_CF);
+    tcg_global_set_flag_i32(cpu_NF);
+    tcg_global_set_flag_i32(cpu_VF);
+    tcg_global_set_flag_i32(cpu_ZF);
 
     cpu_exclusive_addr = tcg_global_mem_new_i64(tcg_env,
         offsetof(CPUARMState, exclusive_addr), "exclusive_addr");
@@ -40,6 +40,7 @@ typedef struct TranslateResult {
     hwaddr paddr;
     int prot;
     int page_size;
+    int map_size;
 } TranslateResult;
 
 typedef enum TranslateFaultStage2 {
@@ -155,7 +156,7 @@ static bool mmu_translate(CPUX86State *env, const TranslateParams *in,
     };
     hwaddr pte_addr, paddr;
     uint32_t pkr;
-    int page_size;
+    int page_size, map_size;
     int error_code;
     int prot;
 
@@ -438,6 +439,7 @@ do_check_protect_pse36:
     /* merge offset within page */
     paddr = (pte & PG_ADDRESS_MASK & ~(page_size - 1)) | (addr & (page_size - 1));
  stage2:
+    map_size = page_size;
 
     /*
      * Note that NPT is walked (for both paging structures and final guest
@@ -473,16 +475,24 @@ do_check_protect_pse36:
 
         /*
          * Use the larger of stage1 & stage2 page sizes, so that
-         * invalidation works.
+         * invalidation works.  The translation is only the same
+         * across the smaller of the two.
          */
+        map_size = MIN(page_size, 1 << full->lg_map_size);
         if (nested_page_size > page_size) {
             page_size = nested_page_size;
         }
     }
 
+    /* With A20 masked, the physical address wraps every megabyte. */
+    if (~x86_get_a20_mask(env) & (map_size - 1)) {
+        map_size = 1024 * 1024;
+    }
+
     out->paddr = paddr & x86_get_a20_mask(env);
     out->prot = prot;
     out->page_size = page_size;
+    out->map_size = map_size;
     return true;
 
  do_fault_rsvd:
@@ -607,6 +617,7 @@ static bool get_physical_address(CPUX86State *env, vaddr addr,
     out->paddr = addr & x86_get_a20_mask(env);
     out->prot = PAGE_READ | PAGE_WRITE | PAGE_EXEC;
     out->page_size = TARGET_PAGE_SIZE;
+    out->map_size = TARGET_PAGE_SIZE;
     return true;
 }
 
@@ -622,13 +633,19 @@ bool x86_cpu_tlb_fill(CPUState *cs, vaddr addr, int size,
                              retaddr)) {
         /*
          * Even if 4MB pages, we map only one 4KB page in the cache to
-         * avoid filling it too fast.
+         * avoid filling it too fast.  The rest of the page is filled
+         * from the same translation without walking the page tables.
          */
+        CPUTLBEntryFull full = {
+            .phys_addr = out.paddr & TARGET_PAGE_MASK,
+            .attrs = cpu_get_mem_attrs(env),
+            .prot = out.prot,
+            .lg_page_size = ctz32(out.page_size),
+            .lg_map_size = ctz32(out.map_size),
+        };
+
         assert(out.prot & (1 << access_type));
-        tlb_set_page_with_attrs(cs, addr & TARGET_PAGE_MASK,
-                                out.paddr & TARGET_PAGE_MASK,
-                                cpu_get_mem_attrs(env),
-                                out.prot, mmu_idx, out.page_size);
+        tlb_set_page_full(cs, mmu_idx, addr & TARGET_PAGE_MASK, &full);
         return true;
     }
 
@@ -3408,6 +3408,10 @@ void tcg_x86_init(void)
                                     "cc_src");
     cpu_cc_src2 = tcg_global_mem_new(tcg_env, offsetof(CPUX86State, cc_src2),
                                      "cc_src2");
+    tcg_global_set_flag_i32(cpu_cc_op);
+    tcg_global_set_flag(cpu_cc_dst);
+    tcg_global_set_flag(cpu_cc_src);
+    tcg_global_set_flag(cpu_cc_src2);
     cpu_eip = tcg_global_mem_new(tcg_env, offsetof(CPUX86State, eip), eip_name);
 
     for (i = 0; i < CPU_NB_REGS; ++i) {
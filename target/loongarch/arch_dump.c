@@ -22,6 +22,7 @@
 #include "elf.h"
 #include "system/dump.h"
 #include "internals.h"
+#include "system/tcg.h"
 
 /* struct user_pt_regs from arch/loongarch/include/uapi/asm/ptrace.h */
 struct loongarch_user_regs {
@@ -95,6 +96,11 @@ static int loongarch_write_elf64_fprpreg(WriteCoreDumpFunction f,
     struct loongarch_note note;
     int ret, i;
 
+#ifdef CONFIG_TCG
+    if (tcg_enabled()) {
+        loongarch_fcsr0_fold(env);
+    }
+#endif
     loongarch_note_init(&note, s, "CORE", 5, NT_PRFPREG, sizeof(note.fpu));
     note.fpu.fcsr = cpu_to_dump64(s, env->fcsr0);
     note.fpu.fcc = cpu_to_dump64(s, read_fcc(env));
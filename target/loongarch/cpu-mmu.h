@@ -28,6 +28,7 @@ typedef struct MMUContext {
     int           tlb_index;
     int           mmu_index;
     uint64_t      pte_buddy[2];
+    hwaddr        pte_table; /* base of the last level page table */
 } MMUContext;
 
 static inline bool cpu_has_ptw(CPULoongArchState *env)
@@ -97,6 +98,10 @@ TLBRet get_physical_address(CPULoongArchState *env, MMUContext *context,
                             int is_debug);
 TLBRet loongarch_ptw(CPULoongArchState *env, MMUContext *context,
                      int access_type, int mmu_idx, int debug);
+TLBRet loongarch_ptw_walk(CPULoongArchState *env, MMUContext *context,
+                          int access_type, int mmu_idx, int debug,
+                          int level, uint64_t base);
+uint64_t loongarch_ptw_pgd(CPULoongArchState *env, vaddr address);
 void get_dir_base_width(CPULoongArchState *env, uint64_t *dir_base,
                         uint64_t *dir_width, unsigned int level);
 hwaddr loongarch_cpu_get_phys_addr_debug(CPUState *cpu, vaddr addr);
@@ -679,6 +679,12 @@ static void loongarch_cpu_reset_hold(Object *obj, ResetType type)
     env->pc = 0x1c000000;
 #ifdef CONFIG_TCG
     memset(env->tlb, 0, sizeof(env->tlb));
+    if (tcg_enabled()) {
+        loongarch_asid_slots_reset(env);
+        loongarch_tlb_epoch_reset(env);
+        loongarch_tlb_index_rebuild(env);
+        loongarch_ptw_cache_flush(env);
+    }
 #endif
     if (kvm_enabled()) {
         kvm_arch_reset_vcpu(cs);
@@ -810,6 +816,11 @@ static void loongarch_cpu_dump_state(CPUState *cs, FILE *f, int flags)
     CPULoongArchState *env = cpu_env(cs);
     int i;
 
+#ifdef CONFIG_TCG
+    if (tcg_enabled()) {
+        loongarch_fcsr0_fold(env);
+    }
+#endif
     qemu_fprintf(f, " PC=%016" PRIx64 " ", env->pc);
     qemu_fprintf(f, " FCSR0 0x%08x\n", env->fcsr0);
 
@@ -860,6 +871,7 @@ static const Property loongarch_cpu_properties[] = {
     DEFINE_PROP_INT32("core-id", LoongArchCPU, core_id, 0),
     DEFINE_PROP_INT32("thread-id", LoongArchCPU, thread_id, 0),
     DEFINE_PROP_INT32("node-id", LoongArchCPU, node_id, CPU_UNSET_NUMA_NODE_ID),
+    DEFINE_PROP_BOOL("tlbr-walk", LoongArchCPU, tlbr_walk, false),
 };
 
 static void loongarch_cpu_class_init(ObjectClass *c, const void *data)
@@ -248,6 +248,13 @@ extern const char * const fregnames[32];
 #define LOONGARCH_MTLB         64   /* 64 MTLB */
 #define LOONGARCH_TLB_MAX      (LOONGARCH_STLB + LOONGARCH_MTLB)
 
+/*
+ * Number of ASIDs whose softmmu TLB contents are kept alive at the same
+ * time; each ASID slot owns one mmu_idx per PLV.
+ */
+#define LOONGARCH_ASID_SLOTS   5
+#define LOONGARCH_ASID_INVALID 0xffff
+
 /*
  * define the ASID PS E VPPN field of TLB
  */
@@ -289,8 +296,51 @@ struct LoongArchTLB {
     /* Fields corresponding to CSR_TLBELO0/1 */
     uint64_t tlb_entry0;
     uint64_t tlb_entry1;
+    /* Value of LoongArchTLBEpoch.epoch when the entry was written */
+    uint64_t fill_epoch;
 };
 typedef struct LoongArchTLB LoongArchTLB;
+
+/*
+ * Epochs of the last INVTLB operations covering many entries. Entries
+ * with a fill_epoch older than a matching invalidation are stale, they
+ * are dropped when next looked at instead of being cleared eagerly.
+ */
+typedef struct LoongArchTLBEpoch {
+    uint64_t epoch;
+    uint64_t inv_all;
+    uint64_t inv_g;     /* All global entries */
+    uint64_t inv_ng;    /* All non-global entries */
+    uint64_t inv_asid[1 << R_CSR_ASID_ASID_LENGTH];
+} LoongArchTLBEpoch;
+
+#define LOONGARCH_PTW_CACHE_SIZE   16
+
+/*
+ * Recently walked last level page tables, used when the TLB is refilled
+ * by QEMU. Like the page walk caches of real hardware, it is dropped by
+ * INVTLB, TLBCLR and TLBFLUSH.
+ */
+typedef struct LoongArchPTWCache {
+    uint64_t pgd;
+    uint64_t tag;       /* Virtual address bits above the last level */
+    hwaddr pte_table;   /* Zero if invalid */
+} LoongArchPTWCache;
+
+#define LOONGARCH_MTLB_HASH_BITS   7
+
+/*
+ * Lookup index of the MTLB, derived from env->tlb and not migrated.
+ * Valid MTLB entries are hashed by page size and VPN, and chained
+ * through mtlb_next[] with -1 as terminator.
+ */
+typedef struct LoongArchTLBIndex {
+    uint64_t mtlb_valid;    /* Bitmap of indexed MTLB entries */
+    uint64_t mtlb_ps_mask;  /* Page sizes of indexed MTLB entries */
+    uint8_t mtlb_ps_count[64];
+    int8_t mtlb_head[1 << LOONGARCH_MTLB_HASH_BITS];
+    int8_t mtlb_next[LOONGARCH_MTLB];
+} LoongArchTLBIndex;
 #endif
 
 enum loongarch_features {
@@ -413,6 +463,14 @@ typedef struct CPUArchState {
 #ifndef CONFIG_USER_ONLY
 #ifdef CONFIG_TCG
     LoongArchTLB  tlb[LOONGARCH_TLB_MAX];
+    LoongArchTLBIndex tlb_index;
+    LoongArchTLBEpoch tlb_epoch;
+    LoongArchPTWCache ptw_cache[LOONGARCH_PTW_CACHE_SIZE];
+    /* ASID owning each group of softmmu TLB mmu_idx, and its LRU stamp */
+    uint16_t asid_slot_tag[LOONGARCH_ASID_SLOTS];
+    uint32_t asid_slot_age[LOONGARCH_ASID_SLOTS];
+    uint32_t asid_slot_clock;
+    uint32_t asid_slot; /* Slot of the current CSR_ASID.ASID */
 #endif
 
     AddressSpace *address_space_iocsr;
@@ -442,6 +500,7 @@ struct ArchCPU {
     OnOffAuto lbt;
     OnOffAuto pmu;
     OnOffAuto ptw;
+    bool tlbr_walk;
     OnOffAuto lsx;
     OnOffAuto lasx;
     OnOffAuto msgint;
@@ -485,6 +544,32 @@ struct LoongArchCPUClass {
 #define MMU_USER_IDX     MMU_PLV_USER
 #define MMU_DA_IDX       4
 
+/*
+ * Paged mode mmu_idx are tagged with an ASID slot, so that switching
+ * back to a recently used ASID finds its softmmu TLB entries still warm.
+ * Slot 0 uses mmu_idx 0-3, slot N uses MMU_DA_IDX + 1 + (N - 1) * 4 + PLV.
+ */
+static inline int loongarch_mmu_idx(int plv, int asid_slot)
+{
+    if (asid_slot == 0) {
+        return plv;
+    }
+    return MMU_DA_IDX + 1 + (asid_slot - 1) * 4 + plv;
+}
+
+static inline int loongarch_mmu_idx_to_plv(int mmu_idx)
+{
+    if (mmu_idx <= MMU_DA_IDX) {
+        return mmu_idx;
+    }
+    return (mmu_idx - MMU_DA_IDX - 1) & 3;
+}
+
+static inline uint32_t loongarch_asid_slot_idxmap(int asid_slot)
+{
+    return 0xf << loongarch_mmu_idx(0, asid_slot);
+}
+
 static inline CPUSysState *env_sys(CPULoongArchState *env)
 {
     return env->sys_state;
@@ -530,6 +615,9 @@ static inline void set_pc(CPULoongArchState *env, uint64_t value)
 #define HW_FLAGS_CRMD_PG    R_CSR_CRMD_PG_MASK   /* 0x10 */
 #define HW_FLAGS_VA32       0x20
 #define HW_FLAGS_EUEN_ASXE  0x40
+#define HW_FLAGS_ASID_SLOT_SHIFT    7
+#define HW_FLAGS_ASID_SLOT_MASK     (0x7 << HW_FLAGS_ASID_SLOT_SHIFT)
+#define HW_FLAGS_FP_LAZY    0x400  /* FCSR0 enables clear, flags pending */
 
 #define CPU_RESOLVING_TYPE TYPE_LOONGARCH_CPU
 
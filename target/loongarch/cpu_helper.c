@@ -51,7 +51,7 @@ void get_dir_base_width(CPULoongArchState *env, uint64_t *dir_base,
 TLBRet loongarch_check_pte(CPULoongArchState *env, MMUContext *context,
                            MMUAccessType access_type, int mmu_idx)
 {
-    uint64_t plv = mmu_idx;
+    uint64_t plv = loongarch_mmu_idx_to_plv(mmu_idx);
     uint64_t tlb_entry, tlb_ppn;
     uint8_t tlb_ps, tlb_plv, tlb_nx, tlb_nr, tlb_rplv;
     bool tlb_v, tlb_d;
@@ -146,36 +146,52 @@ static MemTxResult loongarch_cmpxchg_phys(CPUState *cs, hwaddr phys,
     return ret;
 }
 
-TLBRet loongarch_ptw(CPULoongArchState *env, MMUContext *context,
-                     int access_type, int mmu_idx, int debug)
+uint64_t loongarch_ptw_pgd(CPULoongArchState *env, vaddr address)
+{
+    CPUSysState *sys = env_sys(env);
+    uint64_t base;
+
+    if ((address >> 63) & 0x1) {
+        base = sys->CSR_PGDH;
+    } else {
+        base = sys->CSR_PGDL;
+    }
+    return base & loongarch_palen_mask(env);
+}
+
+/*
+ * Walk the page table from directory @base of @level down to the pte.
+ * The base of the last level table is returned in context->pte_table,
+ * or zero if the walk ended on a huge page.
+ */
+TLBRet loongarch_ptw_walk(CPULoongArchState *env, MMUContext *context,
+                          int access_type, int mmu_idx, int debug,
+                          int level, uint64_t base)
 {
     const MemTxAttrs attrs = MEMTXATTRS_UNSPECIFIED;
     CPUState *cs = env_cpu(env);
     hwaddr index = 0, phys = 0;
     uint64_t palen_mask = loongarch_palen_mask(env);
     uint64_t dir_base, dir_width;
-    uint64_t base, pte;
-    int level;
+    uint64_t pte;
     vaddr address;
     TLBRet ret;
     MemTxResult ret1;
-    CPUSysState *sys = env_sys(env);
 
     address = context->addr;
-    if ((address >> 63) & 0x1) {
-        base = sys->CSR_PGDH;
-    } else {
-        base = sys->CSR_PGDL;
-    }
-    base &= palen_mask;
+    context->pte_table = 0;
 
-    for (level = 4; level >= 0; level--) {
+    for (; level >= 0; level--) {
         get_dir_base_width(env, &dir_base, &dir_width, level);
 
         if (dir_width == 0) {
             continue;
         }
 
+        if (level == 0) {
+            context->pte_table = base;
+        }
+
         /* get next level page directory */
         index = (address >> dir_base) & ((1 << dir_width) - 1);
         phys = base | index << 3;
@@ -208,7 +224,7 @@ restart:
         context->pte_buddy[index] = base;
         context->pte_buddy[1 - index] = base + BIT_ULL(dir_base);
         base += (BIT_ULL(dir_base) & address);
-    } else if (cpu_has_ptw(env)) {
+    } else if (!debug) {
         uint64_t val;
 
         index &= 1;
@@ -273,6 +289,13 @@ restart:
     return ret;
 }
 
+TLBRet loongarch_ptw(CPULoongArchState *env, MMUContext *context,
+                     int access_type, int mmu_idx, int debug)
+{
+    return loongarch_ptw_walk(env, context, access_type, mmu_idx, debug, 4,
+                              loongarch_ptw_pgd(env, context->addr));
+}
+
 static TLBRet loongarch_map_address(CPULoongArchState *env,
                                     MMUContext *context,
                                     MMUAccessType access_type, int mmu_idx,
@@ -314,8 +337,9 @@ TLBRet get_physical_address(CPULoongArchState *env, MMUContext *context,
                             MMUAccessType access_type, int mmu_idx,
                             int is_debug)
 {
-    int user_mode = mmu_idx == MMU_USER_IDX;
-    int kernel_mode = mmu_idx == MMU_KERNEL_IDX;
+    int plv_idx = loongarch_mmu_idx_to_plv(mmu_idx);
+    int user_mode = plv_idx == MMU_USER_IDX;
+    int kernel_mode = plv_idx == MMU_KERNEL_IDX;
     uint32_t plv, base_c, base_v;
     int64_t addr_high;
     CPUSysState *sys = env_sys(env);
@@ -9,6 +9,7 @@
 #include "qemu/osdep.h"
 #include "cpu.h"
 #include "internals.h"
+#include "system/tcg.h"
 #include "exec/gdbstub.h"
 #include "gdbstub/helpers.h"
 #include "vec.h"
@@ -96,6 +97,11 @@ static int loongarch_gdb_get_fpu(CPUState *cs, GByteArray *mem_buf, int n)
     } else if (32 <= n && n < 40) {
         return gdb_get_reg8(mem_buf, env->cf[n - 32]);
     } else if (n == 40) {
+#ifdef CONFIG_TCG
+        if (tcg_enabled()) {
+            loongarch_fcsr0_fold(env);
+        }
+#endif
         return gdb_get_reg32(mem_buf, env->fcsr0);
     }
     return 0;
@@ -115,6 +121,11 @@ static int loongarch_gdb_set_fpu(CPUState *cs, uint8_t *mem_buf, int n)
         length = 1;
     } else if (n == 40) {
         env->fcsr0 = ldl_le_p(mem_buf);
+#ifdef CONFIG_TCG
+        if (tcg_enabled()) {
+            restore_fp_status(env);
+        }
+#endif
         length = 4;
     }
     return length;
@@ -15,6 +15,9 @@
 
 #define TARGET_VIRT_MASK MAKE_64BIT_MASK(0, TARGET_VIRT_ADDR_SPACE_BITS)
 
+/* Smallest page size mapped by a directory entry: 2MB with 4KB pages */
+#define LOONGARCH_HUGE_PAGE_BITS 21
+
 void loongarch_translate_init(void);
 void loongarch_translate_code(CPUState *cs, TranslationBlock *tb,
                               int *max_insns, vaddr pc, void *host_pc);
@@ -26,6 +29,9 @@ void G_NORETURN do_raise_exception(CPULoongArchState *env,
 #ifdef CONFIG_TCG
 int ieee_ex_to_loongarch(int xcpt);
 void restore_fp_status(CPULoongArchState *env);
+void loongarch_fcsr0_fold(CPULoongArchState *env);
+bool loongarch_fp_status_seeded(CPULoongArchState *env);
+void loongarch_fp_status_seed(CPULoongArchState *env);
 #endif
 
 #ifndef CONFIG_USER_ONLY
@@ -10,6 +10,11 @@
 #include "migration/vmstate.h"
 #include "system/tcg.h"
 #include "vec.h"
+#include "internals.h"
+#if defined(CONFIG_TCG) && !defined(CONFIG_USER_ONLY)
+#include "exec/cputlb.h"
+#include "tcg/tcg_loongarch.h"
+#endif
 
 static const VMStateDescription vmstate_fpu_reg = {
     .name = "fpu_reg",
@@ -32,11 +37,38 @@ static bool fpu_needed(void *opaque)
     return FIELD_EX64(cpu->env.cpucfg[2], CPUCFG2, FP);
 }
 
+static int fpu_pre_save(void *opaque)
+{
+#ifdef CONFIG_TCG
+    LoongArchCPU *cpu = opaque;
+
+    /* fp_status is not migrated, fold the lazily accumulated flags */
+    if (tcg_enabled()) {
+        loongarch_fcsr0_fold(&cpu->env);
+    }
+#endif
+    return 0;
+}
+
+static int fpu_post_load(void *opaque, int version_id)
+{
+#ifdef CONFIG_TCG
+    LoongArchCPU *cpu = opaque;
+
+    if (tcg_enabled()) {
+        restore_fp_status(&cpu->env);
+    }
+#endif
+    return 0;
+}
+
 static const VMStateDescription vmstate_fpu = {
     .name = "cpu/fpu",
     .version_id = 1,
     .minimum_version_id = 1,
     .needed = fpu_needed,
+    .pre_save = fpu_pre_save,
+    .post_load = fpu_post_load,
     .fields = (const VMStateField[]) {
         VMSTATE_FPU_REGS(env.fpr, LoongArchCPU, 0),
         VMSTATE_UINT32(env.fcsr0, LoongArchCPU),
@@ -194,11 +226,35 @@ static const VMStateDescription vmstate_tlb_entry = {
     }
 };
 
+static int tlb_pre_save(void *opaque)
+{
+    LoongArchCPU *cpu = opaque;
+
+    /* Epochs are not migrated, clear bit E of lazily invalidated entries */
+    loongarch_tlb_drop_stale(&cpu->env);
+    return 0;
+}
+
+static int tlb_post_load(void *opaque, int version_id)
+{
+    LoongArchCPU *cpu = opaque;
+
+    /* The QEMU TLB starts empty, rebind the current ASID to slot 0 */
+    loongarch_asid_slots_reset(&cpu->env);
+    loongarch_tlb_epoch_reset(&cpu->env);
+    loongarch_tlb_index_rebuild(&cpu->env);
+    loongarch_ptw_cache_flush(&cpu->env);
+    tlb_flush(CPU(cpu));
+    return 0;
+}
+
 static const VMStateDescription vmstate_tlb = {
     .name = "cpu/tlb",
     .version_id = 0,
     .minimum_version_id = 0,
     .needed = tlb_needed,
+    .pre_save = tlb_pre_save,
+    .post_load = tlb_post_load,
     .fields = (const VMStateField[]) {
         VMSTATE_STRUCT_ARRAY(env.tlb, LoongArchCPU, LOONGARCH_TLB_MAX,
                              0, vmstate_tlb_entry, LoongArchTLB),
@@ -17,6 +17,7 @@
 #include "hw/core/irq.h"
 #include "cpu-csr.h"
 #include "cpu-mmu.h"
+#include "tcg/tcg_loongarch.h"
 
 target_ulong helper_csrwr_stlbps(CPULoongArchState *env, target_ulong val)
 {
@@ -118,7 +119,7 @@ target_ulong helper_csrwr_asid(CPULoongArchState *env, target_ulong val)
     /* Only ASID filed of CSR_ASID can be written */
     sys->CSR_ASID = deposit64(sys->CSR_ASID, 0, 10, val);
     if (old_v != sys->CSR_ASID) {
-        tlb_flush(env_cpu(env));
+        loongarch_asid_slot_switch(env);
     }
     return old_v;
 }
@@ -169,6 +170,7 @@ target_ulong helper_csrwr_pwcl(CPULoongArchState *env, target_ulong val)
                       "Attempted set ptbase 2^%d\n", ptbase);
     }
     sys->CSR_PWCL = val;
+    loongarch_ptw_cache_flush(env);
     return old_v;
 }
 
@@ -185,5 +187,6 @@ target_ulong helper_csrwr_pwch(CPULoongArchState *env, target_ulong val)
     }
 
     sys->CSR_PWCH = val;
+    loongarch_ptw_cache_flush(env);
     return old_v;
  }
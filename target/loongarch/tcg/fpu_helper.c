@@ -25,6 +25,25 @@ static const FloatRoundMode ieee_rm[4] = {
     float_round_down
 };
 
+/*
+ * softfloat only takes its host FPU fast path when Inexact is already
+ * raised in fp_status, as it cannot detect an inexact result cheaply.
+ * While traps are disabled and FCSR0 has recorded Inexact anyway, keep
+ * it raised in fp_status. Folding it again leaves Flags unchanged, and
+ * loongarch_fcsr0_fold() keeps it out of Cause.
+ */
+bool loongarch_fp_status_seeded(CPULoongArchState *env)
+{
+    return !GET_FP_ENABLES(env->fcsr0) &&
+           (GET_FP_FLAGS(env->fcsr0) & FP_INEXACT);
+}
+
+void loongarch_fp_status_seed(CPULoongArchState *env)
+{
+    set_float_exception_flags(loongarch_fp_status_seeded(env)
+                              ? float_flag_inexact : 0, &env->fp_status);
+}
+
 void restore_fp_status(CPULoongArchState *env)
 {
     set_float_rounding_mode(ieee_rm[(env->fcsr0 >> FCSR0_RM) & 0x3],
@@ -39,6 +58,8 @@ void restore_fp_status(CPULoongArchState *env)
     set_float_3nan_prop_rule(float_3nan_prop_s_cab, &env->fp_status);
     /* Default NaN: sign bit clear, msb frac bit set */
     set_float_default_nan_pattern(0b01000000, &env->fp_status);
+    /* FCSR0 has been replaced, drop the flags not folded into the old one */
+    loongarch_fp_status_seed(env);
 }
 
 int ieee_ex_to_loongarch(int xcpt)
@@ -62,10 +83,41 @@ int ieee_ex_to_loongarch(int xcpt)
     return ret;
 }
 
-static void update_fcsr0_mask(CPULoongArchState *env, uintptr_t pc, int mask)
+/*
+ * While all exception enables are clear no FP instruction can trap, so
+ * the scalar helpers leave the softfloat flags accumulating in fp_status
+ * and FCSR0 is only brought up to date when it is observed.  The Cause
+ * field then reports the exceptions raised since the last fold rather
+ * than those of the last instruction.
+ */
+void loongarch_fcsr0_fold(CPULoongArchState *env)
 {
     int flags = get_float_exception_flags(&env->fp_status);
 
+    /*
+     * A seeded Inexact cannot be told apart from one raised since, so it
+     * is only accounted in Flags, where it is already recorded.
+     */
+    if (loongarch_fp_status_seeded(env)) {
+        flags &= ~float_flag_inexact;
+    }
+    if (flags) {
+        flags = ieee_ex_to_loongarch(flags);
+        SET_FP_CAUSE(env->fcsr0, flags);
+        UPDATE_FP_FLAGS(env->fcsr0, flags);
+        loongarch_fp_status_seed(env);
+    }
+}
+
+static void update_fcsr0_mask(CPULoongArchState *env, uintptr_t pc, int mask)
+{
+    int flags;
+
+    if (!mask && !GET_FP_ENABLES(env->fcsr0)) {
+        return;
+    }
+
+    flags = get_float_exception_flags(&env->fp_status);
     set_float_exception_flags(0, &env->fp_status);
 
     flags &= ~mask;
@@ -326,6 +378,8 @@ uint64_t helper_flogb_s(CPULoongArchState *env, uint64_t fj)
     float_status *status = &env->fp_status;
     FloatRoundMode old_mode = get_float_rounding_mode(status);
 
+    /* Inexact is masked below, fold what is pending before it */
+    loongarch_fcsr0_fold(env);
     set_float_rounding_mode(float_round_down, status);
     fp = float32_log2((uint32_t)fj, status);
     fd = nanbox_s(float32_round_to_int(fp, status));
@@ -340,6 +394,8 @@ uint64_t helper_flogb_d(CPULoongArchState *env, uint64_t fj)
     float_status *status = &env->fp_status;
     FloatRoundMode old_mode = get_float_rounding_mode(status);
 
+    /* Inexact is masked below, fold what is pending before it */
+    loongarch_fcsr0_fold(env);
     set_float_rounding_mode(float_round_down, status);
     fd = float64_log2(fj, status);
     fd = float64_round_to_int(fd, status);
@@ -878,6 +934,16 @@ uint64_t helper_ftint_w_d(CPULoongArchState *env, uint64_t fj)
     return fd;
 }
 
+void helper_fcsr0_fold(CPULoongArchState *env)
+{
+    loongarch_fcsr0_fold(env);
+}
+
+void helper_fcsr0_seed(CPULoongArchState *env)
+{
+    loongarch_fp_status_seed(env);
+}
+
 void helper_set_rounding_mode(CPULoongArchState *env)
 {
     set_float_rounding_mode(ieee_rm[(env->fcsr0 >> FCSR0_RM) & 0x3],
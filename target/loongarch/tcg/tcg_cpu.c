@@ -283,6 +283,12 @@ static TCGTBCPUState loongarch_get_tb_cpu_state(CPUState *cs)
     flags |= FIELD_EX64(sys->CSR_EUEN, CSR_EUEN, SXE) * HW_FLAGS_EUEN_SXE;
     flags |= FIELD_EX64(sys->CSR_EUEN, CSR_EUEN, ASXE) * HW_FLAGS_EUEN_ASXE;
     flags |= is_va32(env) * HW_FLAGS_VA32;
+    flags |= !GET_FP_ENABLES(env->fcsr0) * HW_FLAGS_FP_LAZY;
+#ifndef CONFIG_USER_ONLY
+    if (flags & HW_FLAGS_CRMD_PG) {
+        flags |= env->asid_slot << HW_FLAGS_ASID_SLOT_SHIFT;
+    }
+#endif
 
     return (TCGTBCPUState){ .pc = env->pc, .flags = flags };
 }
@@ -307,7 +313,13 @@ static int loongarch_cpu_mmu_index(CPUState *cs, bool ifetch)
     CPUSysState *sys = env_sys(env);
 
     if (FIELD_EX64(sys->CSR_CRMD, CSR_CRMD, PG)) {
-        return FIELD_EX64(sys->CSR_CRMD, CSR_CRMD, PLV);
+        int plv = FIELD_EX64(sys->CSR_CRMD, CSR_CRMD, PLV);
+
+#ifndef CONFIG_USER_ONLY
+        return loongarch_mmu_idx(plv, env->asid_slot);
+#else
+        return plv;
+#endif
     }
     return MMU_DA_IDX;
 }
@@ -20,4 +20,11 @@ TLBRet loongarch_get_addr_from_tlb(CPULoongArchState *env,
                                    MMUContext *context,
                                    MMUAccessType access_type, int mmu_idx);
 
+void loongarch_asid_slots_reset(CPULoongArchState *env);
+void loongarch_tlb_index_rebuild(CPULoongArchState *env);
+void loongarch_tlb_epoch_reset(CPULoongArchState *env);
+void loongarch_tlb_drop_stale(CPULoongArchState *env);
+void loongarch_ptw_cache_flush(CPULoongArchState *env);
+void loongarch_asid_slot_switch(CPULoongArchState *env);
+
 #endif  /* TARGET_LOONGARCH_TCG_LOONGARCH_H */
@@ -113,15 +113,246 @@ static void raise_mmu_exception(CPULoongArchState *env, vaddr address,
    }
 }
 
+/*
+ * Forget all ASID to mmu_idx bindings, the caller is responsible for
+ * flushing the QEMU TLB. The current ASID is bound to slot 0.
+ */
+void loongarch_asid_slots_reset(CPULoongArchState *env)
+{
+    CPUSysState *sys = env_sys(env);
+
+    for (int i = 0; i < LOONGARCH_ASID_SLOTS; i++) {
+        env->asid_slot_tag[i] = LOONGARCH_ASID_INVALID;
+        env->asid_slot_age[i] = 0;
+    }
+    env->asid_slot_tag[0] = FIELD_EX64(sys->CSR_ASID, CSR_ASID, ASID);
+    env->asid_slot_age[0] = 1;
+    env->asid_slot_clock = 1;
+    env->asid_slot = 0;
+}
+
+/*
+ * Select the mmu_idx slot for the current CSR_ASID.ASID. A slot that
+ * already holds this ASID is reused with its QEMU TLB entries intact,
+ * otherwise the least recently used slot is flushed and rebound.
+ */
+void loongarch_asid_slot_switch(CPULoongArchState *env)
+{
+    CPUSysState *sys = env_sys(env);
+    uint16_t asid = FIELD_EX64(sys->CSR_ASID, CSR_ASID, ASID);
+    int i, slot = -1, victim = 0;
+
+    if (env->asid_slot_tag[env->asid_slot] == asid) {
+        return;
+    }
+
+    for (i = 0; i < LOONGARCH_ASID_SLOTS; i++) {
+        if (env->asid_slot_tag[i] == asid) {
+            slot = i;
+            break;
+        }
+        if (env->asid_slot_age[i] < env->asid_slot_age[victim]) {
+            victim = i;
+        }
+    }
+
+    if (slot < 0) {
+        slot = victim;
+        tlb_flush_by_mmuidx(env_cpu(env), loongarch_asid_slot_idxmap(slot));
+        env->asid_slot_tag[slot] = asid;
+    }
+
+    env->asid_slot = slot;
+    env->asid_slot_age[slot] = ++env->asid_slot_clock;
+}
+
+/* Return the slot holding QEMU TLB entries of @asid, or -1 */
+static int loongarch_asid_slot_find(CPULoongArchState *env, uint16_t asid)
+{
+    for (int i = 0; i < LOONGARCH_ASID_SLOTS; i++) {
+        if (env->asid_slot_tag[i] == asid) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static uint32_t loongarch_all_asid_idxmap(void)
+{
+    uint32_t idxmap = 0;
+
+    for (int slot = 0; slot < LOONGARCH_ASID_SLOTS; slot++) {
+        idxmap |= loongarch_asid_slot_idxmap(slot);
+    }
+    return idxmap;
+}
+
+static uint32_t loongarch_asid_idxmap(CPULoongArchState *env, bool global,
+                                      uint16_t asid)
+{
+    uint32_t idxmap = 0;
+    int slot;
+
+    if (global) {
+        /* Global entries may be cached under every ASID */
+        return loongarch_all_asid_idxmap();
+    }
+
+    slot = loongarch_asid_slot_find(env, asid);
+    if (slot >= 0) {
+        idxmap = loongarch_asid_slot_idxmap(slot);
+    }
+    return idxmap;
+}
+
+static unsigned mtlb_hash(uint64_t vpn, uint8_t ps)
+{
+    return ((vpn ^ ps) * 0x9e3779b97f4a7c15ULL) >>
+           (64 - LOONGARCH_MTLB_HASH_BITS);
+}
+
+/* VPN of the even/odd page pair, as compared by loongarch_tlb_search_cb() */
+static uint64_t tlb_entry_vpn(LoongArchTLB *tlb, uint8_t tlb_ps)
+{
+    uint64_t tlb_vppn = FIELD_EX64(tlb->tlb_misc, TLB_MISC, VPPN);
+
+    return tlb_vppn >> (tlb_ps + 1 - R_TLB_MISC_VPPN_SHIFT);
+}
+
+/*
+ * Add MTLB entry @index to the lookup index if it is valid. Entries
+ * must be removed with mtlb_index_remove() before tlb_misc is changed.
+ */
+static void mtlb_index_insert(CPULoongArchState *env, int index)
+{
+    LoongArchTLBIndex *idx = &env->tlb_index;
+    LoongArchTLB *tlb = &env->tlb[index];
+    int i = index - LOONGARCH_STLB;
+    uint8_t tlb_ps;
+    unsigned h;
+
+    if (i < 0 || (idx->mtlb_valid & BIT_ULL(i)) ||
+        !FIELD_EX64(tlb->tlb_misc, TLB_MISC, E)) {
+        return;
+    }
+
+    tlb_ps = FIELD_EX64(tlb->tlb_misc, TLB_MISC, PS);
+    h = mtlb_hash(tlb_entry_vpn(tlb, tlb_ps), tlb_ps);
+    idx->mtlb_next[i] = idx->mtlb_head[h];
+    idx->mtlb_head[h] = i;
+    idx->mtlb_valid |= BIT_ULL(i);
+    idx->mtlb_ps_count[tlb_ps]++;
+    idx->mtlb_ps_mask |= BIT_ULL(tlb_ps);
+}
+
+static void mtlb_index_remove(CPULoongArchState *env, int index)
+{
+    LoongArchTLBIndex *idx = &env->tlb_index;
+    LoongArchTLB *tlb = &env->tlb[index];
+    int i = index - LOONGARCH_STLB;
+    uint8_t tlb_ps;
+    int8_t *link;
+
+    if (i < 0 || !(idx->mtlb_valid & BIT_ULL(i))) {
+        return;
+    }
+
+    tlb_ps = FIELD_EX64(tlb->tlb_misc, TLB_MISC, PS);
+    link = &idx->mtlb_head[mtlb_hash(tlb_entry_vpn(tlb, tlb_ps), tlb_ps)];
+    while (*link != i) {
+        assert(*link >= 0);
+        link = &idx->mtlb_next[*link];
+    }
+    *link = idx->mtlb_next[i];
+
+    idx->mtlb_valid &= ~BIT_ULL(i);
+    if (--idx->mtlb_ps_count[tlb_ps] == 0) {
+        idx->mtlb_ps_mask &= ~BIT_ULL(tlb_ps);
+    }
+}
+
+void loongarch_tlb_index_rebuild(CPULoongArchState *env)
+{
+    LoongArchTLBIndex *idx = &env->tlb_index;
+
+    memset(idx, 0, sizeof(*idx));
+    memset(idx->mtlb_head, -1, sizeof(idx->mtlb_head));
+    for (int i = LOONGARCH_STLB; i < LOONGARCH_TLB_MAX; i++) {
+        mtlb_index_insert(env, i);
+    }
+}
+
+void loongarch_tlb_epoch_reset(CPULoongArchState *env)
+{
+    memset(&env->tlb_epoch, 0, sizeof(env->tlb_epoch));
+    for (int i = 0; i < LOONGARCH_TLB_MAX; i++) {
+        env->tlb[i].fill_epoch = 0;
+    }
+}
+
+/* Start a new epoch, entries filled before it are invalidated */
+static uint64_t tlb_epoch_next(CPULoongArchState *env)
+{
+    return ++env->tlb_epoch.epoch;
+}
+
+static bool tlb_entry_stale(CPULoongArchState *env, LoongArchTLB *tlb)
+{
+    LoongArchTLBEpoch *ep = &env->tlb_epoch;
+    uint64_t inv = ep->inv_all;
+
+    if (FIELD_EX64(tlb->tlb_entry0, TLBENTRY, G)) {
+        inv = MAX(inv, ep->inv_g);
+    } else {
+        uint16_t tlb_asid = FIELD_EX64(tlb->tlb_misc, TLB_MISC, ASID);
+
+        inv = MAX(inv, MAX(ep->inv_ng, ep->inv_asid[tlb_asid]));
+    }
+    return tlb->fill_epoch < inv;
+}
+
+/*
+ * Return whether the entry has bit E set and was not invalidated by a
+ * later INVTLB. Stale entries get bit E cleared here, the QEMU TLB was
+ * already flushed when the INVTLB was executed.
+ */
+static bool tlb_entry_live(CPULoongArchState *env, LoongArchTLB *tlb)
+{
+    if (!FIELD_EX64(tlb->tlb_misc, TLB_MISC, E)) {
+        return false;
+    }
+
+    if (unlikely(tlb_entry_stale(env, tlb))) {
+        mtlb_index_remove(env, tlb - env->tlb);
+        tlb->tlb_misc = FIELD_DP64(tlb->tlb_misc, TLB_MISC, E, 0);
+        return false;
+    }
+    return true;
+}
+
+void loongarch_tlb_drop_stale(CPULoongArchState *env)
+{
+    for (int i = 0; i < LOONGARCH_TLB_MAX; i++) {
+        tlb_entry_live(env, &env->tlb[i]);
+    }
+}
+
 static void invalidate_tlb_entry(CPULoongArchState *env, int index)
 {
     target_ulong addr, mask, pagesize;
     uint8_t tlb_ps;
     LoongArchTLB *tlb = &env->tlb[index];
-    int idxmap = BIT(MMU_KERNEL_IDX) | BIT(MMU_USER_IDX);
     uint64_t tlb_vppn = FIELD_EX64(tlb->tlb_misc, TLB_MISC, VPPN);
+    uint16_t tlb_asid = FIELD_EX64(tlb->tlb_misc, TLB_MISC, ASID);
+    bool tlb_g = FIELD_EX64(tlb->tlb_entry0, TLBENTRY, G);
+    uint32_t idxmap = loongarch_asid_idxmap(env, tlb_g, tlb_asid);
     bool tlb_v;
 
+    if (!idxmap) {
+        /* No QEMU TLB entry of this ASID is alive */
+        return;
+    }
+
     tlb_ps = FIELD_EX64(tlb->tlb_misc, TLB_MISC, PS);
     pagesize = MAKE_64BIT_MASK(tlb_ps, 1);
     mask = MAKE_64BIT_MASK(0, tlb_ps + 1);
@@ -144,24 +375,14 @@ static void invalidate_tlb_entry(CPULoongArchState *env, int index)
 static void invalidate_tlb(CPULoongArchState *env, int index)
 {
     LoongArchTLB *tlb;
-    uint16_t csr_asid, tlb_asid, tlb_g;
-    uint8_t tlb_e;
-    CPUSysState *sys = env_sys(env);
 
-    csr_asid = FIELD_EX64(sys->CSR_ASID, CSR_ASID, ASID);
     tlb = &env->tlb[index];
-    tlb_e = FIELD_EX64(tlb->tlb_misc, TLB_MISC, E);
-    if (!tlb_e) {
+    if (!tlb_entry_live(env, tlb)) {
         return;
     }
 
+    mtlb_index_remove(env, index);
     tlb->tlb_misc = FIELD_DP64(tlb->tlb_misc, TLB_MISC, E, 0);
-    tlb_asid = FIELD_EX64(tlb->tlb_misc, TLB_MISC, ASID);
-    tlb_g = FIELD_EX64(tlb->tlb_entry0, TLBENTRY, G);
-    /* QEMU TLB is flushed when asid is changed */
-    if (tlb_g == 0 && tlb_asid != csr_asid) {
-        return;
-    }
     invalidate_tlb_entry(env, index);
 }
 
@@ -220,6 +441,7 @@ static void fill_tlb_entry(CPULoongArchState *env, LoongArchTLB *tlb,
 
     tlb->tlb_entry0 = lo0;
     tlb->tlb_entry1 = lo1;
+    tlb->fill_epoch = env->tlb_epoch.epoch;
 }
 
 /* Return an random value between low and high */
@@ -242,12 +464,13 @@ static LoongArchTLB *loongarch_tlb_search_cb(CPULoongArchState *env,
                                              vaddr vaddr, int csr_asid,
                                              tlb_match func)
 {
+    LoongArchTLBIndex *idx = &env->tlb_index;
     LoongArchTLB *tlb;
     uint16_t tlb_asid, stlb_idx;
     uint8_t tlb_e, tlb_ps, stlb_ps;
     bool tlb_g;
     int i, compare_shift;
-    uint64_t vpn, tlb_vppn;
+    uint64_t vpn, tlb_vppn, ps_mask;
     CPUSysState *sys = env_sys(env);
 
     stlb_ps = FIELD_EX64(sys->CSR_STLBPS, CSR_STLBPS, PS);
@@ -265,25 +488,30 @@ static LoongArchTLB *loongarch_tlb_search_cb(CPULoongArchState *env,
             tlb_g = !!FIELD_EX64(tlb->tlb_entry0, TLBENTRY, G);
 
             if (func(tlb_g, csr_asid, tlb_asid) &&
-                (vpn == (tlb_vppn >> compare_shift))) {
+                (vpn == (tlb_vppn >> compare_shift)) &&
+                tlb_entry_live(env, tlb)) {
                 return tlb;
             }
         }
     }
 
-    /* Search MTLB */
-    for (i = LOONGARCH_STLB; i < LOONGARCH_TLB_MAX; ++i) {
-        tlb = &env->tlb[i];
-        tlb_e = FIELD_EX64(tlb->tlb_misc, TLB_MISC, E);
-        if (tlb_e) {
-            tlb_vppn = FIELD_EX64(tlb->tlb_misc, TLB_MISC, VPPN);
-            tlb_ps = FIELD_EX64(tlb->tlb_misc, TLB_MISC, PS);
+    /* Search MTLB, probing the index once per page size in use */
+    ps_mask = idx->mtlb_ps_mask;
+    while (ps_mask) {
+        tlb_ps = ctz64(ps_mask);
+        ps_mask &= ps_mask - 1;
+        vpn = (vaddr & TARGET_VIRT_MASK) >> (tlb_ps + 1);
+        for (i = idx->mtlb_head[mtlb_hash(vpn, tlb_ps)]; i >= 0;
+             i = idx->mtlb_next[i]) {
+            tlb = &env->tlb[LOONGARCH_STLB + i];
+            if (FIELD_EX64(tlb->tlb_misc, TLB_MISC, PS) != tlb_ps ||
+                tlb_entry_vpn(tlb, tlb_ps) != vpn) {
+                continue;
+            }
             tlb_asid = FIELD_EX64(tlb->tlb_misc, TLB_MISC, ASID);
             tlb_g = FIELD_EX64(tlb->tlb_entry0, TLBENTRY, G);
-            compare_shift = tlb_ps + 1 - R_TLB_MISC_VPPN_SHIFT;
-            vpn = (vaddr & TARGET_VIRT_MASK) >> (tlb_ps + 1);
-            if (func(tlb_g, csr_asid, tlb_asid) &&
-                (vpn == (tlb_vppn >> compare_shift))) {
+            /* Removing a stale entry keeps mtlb_next[i] intact */
+            if (func(tlb_g, csr_asid, tlb_asid) && tlb_entry_live(env, tlb)) {
                 return tlb;
             }
         }
@@ -340,12 +568,13 @@ void helper_tlbrd(CPULoongArchState *env)
     index = FIELD_EX64(sys->CSR_TLBIDX, CSR_TLBIDX, INDEX);
     tlb = &env->tlb[index];
     tlb_ps = FIELD_EX64(tlb->tlb_misc, TLB_MISC, PS);
-    tlb_e = FIELD_EX64(tlb->tlb_misc, TLB_MISC, E);
+    tlb_e = tlb_entry_live(env, tlb);
 
     if (!tlb_e) {
         /* Invalid TLB entry */
         sys->CSR_TLBIDX = FIELD_DP64(sys->CSR_TLBIDX, CSR_TLBIDX, NE, 1);
         sys->CSR_ASID  = FIELD_DP64(sys->CSR_ASID, CSR_ASID, ASID, 0);
+        loongarch_asid_slot_switch(env);
         sys->CSR_TLBEHI = 0;
         sys->CSR_TLBELO0 = 0;
         sys->CSR_TLBELO1 = 0;
@@ -386,7 +615,9 @@ static void update_tlb_index(CPULoongArchState *env, MMUContext *context,
         invalidate_tlb(env, index);
     }
 
+    mtlb_index_remove(env, index);
     *old = new;
+    mtlb_index_insert(env, index);
 }
 
 void helper_tlbwr(CPULoongArchState *env)
@@ -411,7 +642,7 @@ static int get_tlb_random_index(CPULoongArchState *env, vaddr addr,
     int index, set, i, stlb_idx;
     uint16_t asid, tlb_asid, stlb_ps;
     LoongArchTLB *tlb;
-    uint8_t tlb_e, tlb_g;
+    uint8_t tlb_g;
     CPUSysState *sys = env_sys(env);
 
     /* Validity of stlb_ps is checked in helper_csrwr_stlbps() */
@@ -424,8 +655,7 @@ static int get_tlb_random_index(CPULoongArchState *env, vaddr addr,
         stlb_idx = (address >> (stlb_ps + 1)) & 0xff; /* [0,255] */
         for (i = 0; i < 8; ++i) {
             tlb = &env->tlb[i * 256 + stlb_idx];
-            tlb_e = FIELD_EX64(tlb->tlb_misc, TLB_MISC, E);
-            if (!tlb_e) {
+            if (!tlb_entry_live(env, tlb)) {
                 set = i;
                 break;
             }
@@ -443,13 +673,15 @@ static int get_tlb_random_index(CPULoongArchState *env, vaddr addr,
         }
         index = set * 256 + stlb_idx;
     } else {
-        /* Only write into MTLB */
+        /* Only write into MTLB, prefer the first invalid entry */
+        if (~env->tlb_index.mtlb_valid) {
+            return LOONGARCH_STLB + ctz64(~env->tlb_index.mtlb_valid);
+        }
+
         index = -1;
         for (i = LOONGARCH_STLB; i < LOONGARCH_TLB_MAX; i++) {
             tlb = &env->tlb[i];
-            tlb_e = FIELD_EX64(tlb->tlb_misc, TLB_MISC, E);
-
-            if (!tlb_e) {
+            if (!tlb_entry_live(env, tlb)) {
                 index = i;
                 break;
             }
@@ -490,6 +722,7 @@ void helper_tlbfill(CPULoongArchState *env)
     index = get_tlb_random_index(env, entryhi, pagesize);
     invalidate_tlb(env, index);
     fill_tlb_entry(env, env->tlb + index, &context);
+    mtlb_index_insert(env, index);
 }
 
 void helper_tlbclr(CPULoongArchState *env)
@@ -499,6 +732,7 @@ void helper_tlbclr(CPULoongArchState *env)
     uint16_t csr_asid, tlb_asid, tlb_g;
     CPUSysState *sys = env_sys(env);
 
+    loongarch_ptw_cache_flush(env);
     csr_asid = FIELD_EX64(sys->CSR_ASID, CSR_ASID, ASID);
     index = FIELD_EX64(sys->CSR_TLBIDX, CSR_TLBIDX, INDEX);
 
@@ -509,7 +743,7 @@ void helper_tlbclr(CPULoongArchState *env)
             tlb_asid = FIELD_EX64(tlb->tlb_misc, TLB_MISC, ASID);
             tlb_g = FIELD_EX64(tlb->tlb_entry0, TLBENTRY, G);
             if (!tlb_g && tlb_asid == csr_asid) {
-                tlb->tlb_misc = FIELD_DP64(tlb->tlb_misc, TLB_MISC, E, 0);
+                invalidate_tlb(env, tlb - env->tlb);
             }
         }
     } else if (index < LOONGARCH_TLB_MAX) {
@@ -519,12 +753,10 @@ void helper_tlbclr(CPULoongArchState *env)
             tlb_asid = FIELD_EX64(tlb->tlb_misc, TLB_MISC, ASID);
             tlb_g = FIELD_EX64(tlb->tlb_entry0, TLBENTRY, G);
             if (!tlb_g && tlb_asid == csr_asid) {
-                tlb->tlb_misc = FIELD_DP64(tlb->tlb_misc, TLB_MISC, E, 0);
+                invalidate_tlb(env, i);
             }
         }
     }
-
-    tlb_flush(env_cpu(env));
 }
 
 void helper_tlbflush(CPULoongArchState *env)
@@ -532,62 +764,57 @@ void helper_tlbflush(CPULoongArchState *env)
     int i, index;
     CPUSysState *sys = env_sys(env);
 
+    loongarch_ptw_cache_flush(env);
     index = FIELD_EX64(sys->CSR_TLBIDX, CSR_TLBIDX, INDEX);
 
     if (index < LOONGARCH_STLB) {
         /* STLB. One line per operation */
         for (i = 0; i < 8; i++) {
-            int s_idx = i * 256 + (index % 256);
-            env->tlb[s_idx].tlb_misc = FIELD_DP64(env->tlb[s_idx].tlb_misc,
-                                                  TLB_MISC, E, 0);
+            invalidate_tlb(env, i * 256 + (index % 256));
         }
     } else if (index < LOONGARCH_TLB_MAX) {
         /* All MTLB entries */
         for (i = LOONGARCH_STLB; i < LOONGARCH_TLB_MAX; i++) {
-            env->tlb[i].tlb_misc = FIELD_DP64(env->tlb[i].tlb_misc,
-                                              TLB_MISC, E, 0);
+            invalidate_tlb(env, i);
         }
     }
-
-    tlb_flush(env_cpu(env));
 }
 
+/*
+ * The INVTLB operations on all entries, all global or non-global entries
+ * and all entries of one ASID only open a new epoch, see tlb_entry_live().
+ * The QEMU TLB of the direct mapped mmu_idx is never affected.
+ */
 void helper_invtlb_all(CPULoongArchState *env)
 {
-    for (int i = 0; i < LOONGARCH_TLB_MAX; i++) {
-        env->tlb[i].tlb_misc = FIELD_DP64(env->tlb[i].tlb_misc,
-                                          TLB_MISC, E, 0);
-    }
-    tlb_flush(env_cpu(env));
+    loongarch_ptw_cache_flush(env);
+    env->tlb_epoch.inv_all = tlb_epoch_next(env);
+    tlb_flush_by_mmuidx(env_cpu(env), loongarch_all_asid_idxmap());
 }
 
 void helper_invtlb_all_g(CPULoongArchState *env, uint32_t g)
 {
-    for (int i = 0; i < LOONGARCH_TLB_MAX; i++) {
-        LoongArchTLB *tlb = &env->tlb[i];
-        uint8_t tlb_g = FIELD_EX64(tlb->tlb_entry0, TLBENTRY, G);
-
-        if (tlb_g == g) {
-            tlb->tlb_misc = FIELD_DP64(tlb->tlb_misc, TLB_MISC, E, 0);
-        }
+    loongarch_ptw_cache_flush(env);
+    if (g) {
+        env->tlb_epoch.inv_g = tlb_epoch_next(env);
+    } else {
+        env->tlb_epoch.inv_ng = tlb_epoch_next(env);
     }
-    tlb_flush(env_cpu(env));
+    tlb_flush_by_mmuidx(env_cpu(env), loongarch_all_asid_idxmap());
 }
 
 void helper_invtlb_all_asid(CPULoongArchState *env, target_ulong info)
 {
     uint16_t asid = info & R_CSR_ASID_ASID_MASK;
+    uint32_t idxmap;
 
-    for (int i = 0; i < LOONGARCH_TLB_MAX; i++) {
-        LoongArchTLB *tlb = &env->tlb[i];
-        uint8_t tlb_g = FIELD_EX64(tlb->tlb_entry0, TLBENTRY, G);
-        uint16_t tlb_asid = FIELD_EX64(tlb->tlb_misc, TLB_MISC, ASID);
+    loongarch_ptw_cache_flush(env);
+    env->tlb_epoch.inv_asid[asid] = tlb_epoch_next(env);
 
-        if (!tlb_g && (tlb_asid == asid)) {
-            tlb->tlb_misc = FIELD_DP64(tlb->tlb_misc, TLB_MISC, E, 0);
-        }
+    idxmap = loongarch_asid_idxmap(env, false, asid);
+    if (idxmap) {
+        tlb_flush_by_mmuidx(env_cpu(env), idxmap);
     }
-    tlb_flush(env_cpu(env));
 }
 
 void helper_invtlb_page_asid(CPULoongArchState *env, target_ulong info,
@@ -597,6 +824,7 @@ void helper_invtlb_page_asid(CPULoongArchState *env, target_ulong info,
     LoongArchTLB *tlb;
     tlb_match func;
 
+    loongarch_ptw_cache_flush(env);
     func = tlb_match_asid;
     tlb = loongarch_tlb_search_cb(env, addr, asid, func);
     if (tlb) {
@@ -611,6 +839,7 @@ void helper_invtlb_page_asid_or_g(CPULoongArchState *env,
     LoongArchTLB *tlb;
     tlb_match func;
 
+    loongarch_ptw_cache_flush(env);
     func = tlb_match_any;
     tlb = loongarch_tlb_search_cb(env, addr, asid, func);
     if (tlb) {
@@ -630,6 +859,73 @@ static void ptw_update_tlb(CPULoongArchState *env, MMUContext *context)
     update_tlb_index(env, context, index);
 }
 
+static inline uint64_t loongarch_sanitize_hw_pte(CPULoongArchState *env,
+                                                 uint64_t pte)
+{
+    uint64_t palen_mask = loongarch_palen_mask(env);
+    uint64_t ppn_mask = is_la64(env) ? R_TLBENTRY_64_PPN_MASK : R_TLBENTRY_32_PPN_MASK;
+
+    /*
+     * Keep only architecturally-defined PTE bits. Guests may use some
+     * otherwise-unused bits for software purposes.
+     */
+    pte &= env->hw_pte_mask;
+
+    return (pte & ~ppn_mask) | ((pte & ppn_mask) & palen_mask);
+}
+
+void loongarch_ptw_cache_flush(CPULoongArchState *env)
+{
+    memset(env->ptw_cache, 0, sizeof(env->ptw_cache));
+}
+
+/*
+ * Refill the TLB from the page table the same way as the TLBR handler
+ * of the guest does with LDDIR, LDPTE and TLBFILL, without taking the
+ * exception. Return false if the guest handler has to run instead.
+ */
+static bool loongarch_refill_walk(CPULoongArchState *env, MMUContext *context,
+                                  MMUAccessType access_type, int mmu_idx)
+{
+    CPUSysState *sys = env_sys(env);
+    uint64_t ptbase = FIELD_EX64(sys->CSR_PWCL, CSR_PWCL, PTBASE);
+    uint64_t ptwidth = FIELD_EX64(sys->CSR_PWCL, CSR_PWCL, PTWIDTH);
+    uint64_t pgd = loongarch_ptw_pgd(env, context->addr);
+    uint64_t tag = context->addr >> (ptbase + ptwidth);
+    LoongArchPTWCache *c = &env->ptw_cache[tag % LOONGARCH_PTW_CACHE_SIZE];
+
+    if (c->pte_table && c->pgd == pgd && c->tag == tag) {
+        loongarch_ptw_walk(env, context, access_type, mmu_idx, 0, 0,
+                           c->pte_table);
+    } else {
+        loongarch_ptw_walk(env, context, access_type, mmu_idx, 0, 4, pgd);
+
+        /*
+         * An empty directory entry points at a shared table of invalid
+         * ptes (invalid_pte_table in Linux), which the guest replaces
+         * without flushing when it populates the range. Only remember
+         * tables that actually map something.
+         */
+        if (FIELD_EX64(context->pte_buddy[0], TLBENTRY, V) ||
+            FIELD_EX64(context->pte_buddy[1], TLBENTRY, V)) {
+            c->pgd = pgd;
+            c->tag = tag;
+            c->pte_table = context->pte_table;
+        }
+    }
+
+    if (!check_ps(env, context->ps)) {
+        return false;
+    }
+
+    context->pte_buddy[0] = loongarch_sanitize_hw_pte(env,
+                                                      context->pte_buddy[0]);
+    context->pte_buddy[1] = loongarch_sanitize_hw_pte(env,
+                                                      context->pte_buddy[1]);
+    ptw_update_tlb(env, context);
+    return true;
+}
+
 bool loongarch_cpu_tlb_fill(CPUState *cs, vaddr address, int size,
                             MMUAccessType access_type, int mmu_idx,
                             bool probe, uintptr_t retaddr)
@@ -643,6 +939,7 @@ bool loongarch_cpu_tlb_fill(CPUState *cs, vaddr address, int size,
     /* Data access */
     context.addr = address;
     context.tlb_index = -1;
+    context.ps = TARGET_PAGE_BITS;
     ret = get_physical_address(env, &context, access_type, mmu_idx, 0);
     if (ret == TLBRET_MATCH && context.mmu_index != MMU_DA_IDX
         && cpu_has_ptw(env)) {
@@ -669,6 +966,15 @@ bool loongarch_cpu_tlb_fill(CPUState *cs, vaddr address, int size,
         }
     }
 
+    if (ret == TLBRET_NOMATCH && !cpu_has_ptw(env) &&
+        env_archcpu(env)->tlbr_walk) {
+        /* Refill in QEMU, then check the access against the new entry */
+        if (loongarch_refill_walk(env, &context, access_type, mmu_idx)) {
+            context.tlb_index = -1;
+            ret = get_physical_address(env, &context, access_type, mmu_idx, 0);
+        }
+    }
+
     if (ret != TLBRET_MATCH && cpu_has_ptw(env)) {
         /* Take HW PTW if TLB missed or bit P is zero */
         if (ret == TLBRET_NOMATCH || ret == TLBRET_INVALID) {
@@ -684,9 +990,26 @@ bool loongarch_cpu_tlb_fill(CPUState *cs, vaddr address, int size,
     if (ret == TLBRET_MATCH) {
         physical = context.physical;
         prot = context.prot;
-        tlb_set_page(cs, address & TARGET_PAGE_MASK,
-                     physical & TARGET_PAGE_MASK, prot,
-                     mmu_idx, TARGET_PAGE_SIZE);
+
+        /*
+         * A huge page maps the same way throughout, so let the rest
+         * of it be filled without searching the TLB again.  Base pages
+         * larger than TARGET_PAGE_SIZE, e.g. 16KB, are not reported as
+         * large: each would take a slot in the large page table of the
+         * softmmu TLB, and pushing them out of it turns later flushes
+         * into full ones.  invalidate_tlb_entry() flushes by range, so
+         * the page size is not needed to invalidate them.
+         */
+        int lg_page_size = context.ps >= LOONGARCH_HUGE_PAGE_BITS ?
+                           context.ps : TARGET_PAGE_BITS;
+        CPUTLBEntryFull full = {
+            .phys_addr = physical & TARGET_PAGE_MASK,
+            .attrs = MEMTXATTRS_UNSPECIFIED,
+            .prot = prot,
+            .lg_page_size = lg_page_size,
+            .lg_map_size = lg_page_size,
+        };
+        tlb_set_page_full(cs, mmu_idx, address & TARGET_PAGE_MASK, &full);
         qemu_log_mask(CPU_LOG_MMU,
                       "%s address=%" VADDR_PRIx " physical " HWADDR_FMT_plx
                       " prot %d\n", __func__, address, physical, prot);
@@ -703,21 +1026,6 @@ bool loongarch_cpu_tlb_fill(CPUState *cs, vaddr address, int size,
     cpu_loop_exit_restore(cs, retaddr);
 }
 
-static inline uint64_t loongarch_sanitize_hw_pte(CPULoongArchState *env,
-                                                 uint64_t pte)
-{
-    uint64_t palen_mask = loongarch_palen_mask(env);
-    uint64_t ppn_mask = is_la64(env) ? R_TLBENTRY_64_PPN_MASK : R_TLBENTRY_32_PPN_MASK;
-
-    /*
-     * Keep only architecturally-defined PTE bits. Guests may use some
-     * otherwise-unused bits for software purposes.
-     */
-    pte &= env->hw_pte_mask;
-
-    return (pte & ~ppn_mask) | ((pte & ppn_mask) & palen_mask);
-}
-
 target_ulong helper_lddir(CPULoongArchState *env, target_ulong base,
                           uint32_t level, uint32_t mem_idx)
 {
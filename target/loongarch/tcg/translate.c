@@ -125,7 +125,10 @@ static void loongarch_tr_init_disas_context(DisasContextBase *dcbase,
     ctx->page_start = ctx->base.pc_first & TARGET_PAGE_MASK;
     ctx->plv = ctx->base.tb->flags & HW_FLAGS_PLV_MASK;
     if (ctx->base.tb->flags & HW_FLAGS_CRMD_PG) {
-        ctx->mem_idx = ctx->plv;
+        int asid_slot = (ctx->base.tb->flags & HW_FLAGS_ASID_SLOT_MASK)
+                        >> HW_FLAGS_ASID_SLOT_SHIFT;
+
+        ctx->mem_idx = loongarch_mmu_idx(ctx->plv, asid_slot);
     } else {
         ctx->mem_idx = MMU_DA_IDX;
     }
@@ -150,6 +153,8 @@ static void loongarch_tr_init_disas_context(DisasContextBase *dcbase,
     ctx->cpucfg1 = env->cpucfg[1];
     ctx->cpucfg2 = env->cpucfg[2];
     ctx->cpucfg3 = env->cpucfg[3];
+
+    ctx->nr_side_exits = 0;
 }
 
 static void loongarch_tr_tb_start(DisasContextBase *dcbase, CPUState *cs)
@@ -307,6 +312,7 @@ static void loongarch_tr_translate_insn(DisasContextBase *dcbase, CPUState *cs)
 static void loongarch_tr_tb_stop(DisasContextBase *dcbase, CPUState *cs)
 {
     DisasContext *ctx = container_of(dcbase, DisasContext, base);
+    int i;
 
     switch (ctx->base.is_jmp) {
     case DISAS_STOP:
@@ -327,6 +333,12 @@ static void loongarch_tr_tb_stop(DisasContextBase *dcbase, CPUState *cs)
     default:
         g_assert_not_reached();
     }
+
+    for (i = 0; i < ctx->nr_side_exits; i++) {
+        gen_set_label(ctx->side_exits[i].label);
+        tcg_gen_movi_tl(cpu_pc, ctx->side_exits[i].dest);
+        tcg_gen_lookup_and_goto_ptr();
+    }
 }
 
 static const TranslatorOps loongarch_tr_ops = {
@@ -924,57 +924,6 @@ void HELPER(vnori_b)(void *vd, void *vj, uint64_t imm, uint32_t desc)
     }
 }
 
-#define VSLLWIL(NAME, BIT, E1, E2)                                             \
-void HELPER(NAME)(void *vd, void *vj, uint64_t imm, uint32_t desc)             \
-{                                                                              \
-    int i, j, ofs;                                                             \
-    VReg temp = {};                                                            \
-    VReg *Vd = (VReg *)vd;                                                     \
-    VReg *Vj = (VReg *)vj;                                                     \
-    int oprsz = simd_oprsz(desc);                                              \
-    typedef __typeof(temp.E1(0)) TD;                                           \
-                                                                               \
-    ofs = LSX_LEN / BIT;                                                       \
-    for (i = 0; i < oprsz / 16; i++) {                                         \
-        for (j = 0; j < ofs; j++) {                                            \
-            temp.E1(j + ofs * i) = (TD)Vj->E2(j + ofs * 2 * i) << (imm % BIT); \
-        }                                                                      \
-    }                                                                          \
-    *Vd = temp;                                                                \
-}
-
-
-void HELPER(vextl_q_d)(void *vd, void *vj, uint32_t desc)
-{
-    int i;
-    VReg *Vd = (VReg *)vd;
-    VReg *Vj = (VReg *)vj;
-    int oprsz = simd_oprsz(desc);
-
-    for (i = 0; i < oprsz / 16; i++) {
-        Vd->Q(i) = int128_makes64(Vj->D(2 * i));
-    }
-}
-
-void HELPER(vextl_qu_du)(void *vd, void *vj, uint32_t desc)
-{
-    int i;
-    VReg *Vd = (VReg *)vd;
-    VReg *Vj = (VReg *)vj;
-    int oprsz = simd_oprsz(desc);
-
-    for (i = 0; i < oprsz / 16; i++) {
-        Vd->Q(i) = int128_make64(Vj->UD(2 * i));
-    }
-}
-
-VSLLWIL(vsllwil_h_b, 16, H, B)
-VSLLWIL(vsllwil_w_h, 32, W, H)
-VSLLWIL(vsllwil_d_w, 64, D, W)
-VSLLWIL(vsllwil_hu_bu, 16, UH, UB)
-VSLLWIL(vsllwil_wu_hu, 32, UW, UH)
-VSLLWIL(vsllwil_du_wu, 64, UD, UW)
-
 #define do_vsrlr(E, T)                                  \
 static T do_vsrlr_ ##E(T s1, int sh)                    \
 {                                                       \
@@ -2375,8 +2324,10 @@ static void vec_update_fcsr0_mask(CPULoongArchState *env,
 {
     int flags = get_float_exception_flags(&env->fp_status);
 
-    set_float_exception_flags(0, &env->fp_status);
-
+    /* As in loongarch_fcsr0_fold, a seeded Inexact is already in Flags */
+    if (loongarch_fp_status_seeded(env)) {
+        flags &= ~float_flag_inexact;
+    }
     flags &= ~mask;
 
     if (flags) {
@@ -2385,10 +2336,12 @@ static void vec_update_fcsr0_mask(CPULoongArchState *env,
     }
 
     if (GET_FP_ENABLES(env->fcsr0) & flags) {
+        loongarch_fp_status_seed(env);
         do_raise_exception(env, EXCCODE_FPE, pc);
-    } else {
-        UPDATE_FP_FLAGS(env->fcsr0, flags);
     }
+    UPDATE_FP_FLAGS(env->fcsr0, flags);
+    /* Keep the hardfloat fast path for the next FP insn, scalar or not */
+    loongarch_fp_status_seed(env);
 }
 
 static void vec_update_fcsr0(CPULoongArchState *env, uintptr_t pc)
@@ -2398,6 +2351,8 @@ static void vec_update_fcsr0(CPULoongArchState *env, uintptr_t pc)
 
 static inline void vec_clear_cause(CPULoongArchState *env)
 {
+    /* Flags left pending by scalar helpers belong to earlier insns */
+    loongarch_fcsr0_fold(env);
     SET_FP_CAUSE(env->fcsr0, 0);
 }
 
@@ -3256,8 +3211,6 @@ void HELPER(NAME)(void *vd, void *vj, void *vk, uint32_t desc)        \
 
 VPICKEV(vpickev_b, 16, B)
 VPICKEV(vpickev_h, 32, H)
-VPICKEV(vpickev_w, 64, W)
-VPICKEV(vpickev_d, 128, D)
 
 #define VPICKOD(NAME, BIT, E)                                             \
 void HELPER(NAME)(void *vd, void *vj, void *vk, uint32_t desc)            \
@@ -3281,8 +3234,6 @@ void HELPER(NAME)(void *vd, void *vj, void *vk, uint32_t desc)            \
 
 VPICKOD(vpickod_b, 16, B)
 VPICKOD(vpickod_h, 32, H)
-VPICKOD(vpickod_w, 64, W)
-VPICKOD(vpickod_d, 128, D)
 
 #define VILVL(NAME, BIT, E)                                         \
 void HELPER(NAME)(void *vd, void *vj, void *vk, uint32_t desc)      \
@@ -3306,8 +3257,6 @@ void HELPER(NAME)(void *vd, void *vj, void *vk, uint32_t desc)      \
 
 VILVL(vilvl_b, 16, B)
 VILVL(vilvl_h, 32, H)
-VILVL(vilvl_w, 64, W)
-VILVL(vilvl_d, 128, D)
 
 #define VILVH(NAME, BIT, E)                                               \
 void HELPER(NAME)(void *vd, void *vj, void *vk, uint32_t desc)            \
@@ -3331,8 +3280,6 @@ void HELPER(NAME)(void *vd, void *vj, void *vk, uint32_t desc)            \
 
 VILVH(vilvh_b, 16, B)
 VILVH(vilvh_h, 32, H)
-VILVH(vilvh_w, 64, W)
-VILVH(vilvh_d, 128, D)
 
 void HELPER(vshuf_b)(void *vd, void *vj, void *vk, void *va, uint32_t desc)
 {
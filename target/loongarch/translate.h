@@ -56,6 +56,14 @@ typedef enum {
     EXT_ZERO,
 } DisasExtend;
 
+/* Branches taken out of a hot trace, see translator_follow_branch. */
+#define MAX_SIDE_EXITS 8
+
+typedef struct DisasSideExit {
+    TCGLabel *label;
+    vaddr dest;
+} DisasSideExit;
+
 typedef struct DisasContext {
     DisasContextBase base;
     target_ulong page_start;
@@ -69,6 +77,8 @@ typedef struct DisasContext {
     uint32_t cpucfg1;
     uint32_t cpucfg2;
     uint32_t cpucfg3;
+    int nr_side_exits;
+    DisasSideExit side_exits[MAX_SIDE_EXITS];
 } DisasContext;
 
 void generate_exception(DisasContext *ctx, int excp);
@@ -216,6 +216,10 @@ void s390x_translate_init(void)
                                     "cc_dst");
     cc_vr = tcg_global_mem_new_i64(tcg_env, offsetof(CPUS390XState, cc_vr),
                                    "cc_vr");
+    tcg_global_set_flag_i32(cc_op);
+    tcg_global_set_flag_i64(cc_src);
+    tcg_global_set_flag_i64(cc_dst);
+    tcg_global_set_flag_i64(cc_vr);
 
     for (i = 0; i < 16; i++) {
         snprintf(cpu_reg_names[i], sizeof(cpu_reg_names[0]), "r%d", i);
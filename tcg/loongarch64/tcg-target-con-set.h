@@ -29,9 +29,11 @@ C_O1_I2(r, r, rJ)
 C_O1_I2(r, r, rU)
 C_O1_I2(r, r, rW)
 C_O1_I2(r, 0, rz)
+C_O1_I2(w, w, r)
 C_O1_I2(w, w, w)
 C_O1_I2(w, w, wM)
 C_O1_I2(w, w, wA)
 C_O1_I3(w, w, w, w)
+C_O1_I4(w, w, wM, w, w)
 C_O1_I4(r, r, rJ, rz, rz)
 C_N2_I1(r, r, r)
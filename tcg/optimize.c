@@ -45,8 +45,34 @@ typedef struct TempOptInfo {
     uint64_t z_mask;  /* mask bit is 0 if and only if value bit is 0 */
     uint64_t o_mask;  /* mask bit is 1 if and only if value bit is 1 */
     uint64_t s_mask;  /* mask bit is 1 if value bit matches msb */
+    uint32_t version; /* bumped whenever the temp is written */
 } TempOptInfo;
 
+/*
+ * A pure op seen earlier in the extended basic block, whose output
+ * still holds its result while no version has changed.
+ */
+#define CSE_BITS      6
+#define CSE_MAX_ARGS  6
+
+typedef struct CSEEntry {
+    unsigned ebb;
+    TCGOpcode opc;
+    unsigned param1, param2;
+    TCGArg args[CSE_MAX_ARGS];        /* inputs, then constant args */
+    uint32_t version[CSE_MAX_ARGS];   /* of the inputs */
+    TCGTemp *out;
+    uint32_t out_version;
+} CSEEntry;
+
+/* A store to env that nothing has read yet. */
+#define MAX_PENDING_ST  16
+
+typedef struct PendingStore {
+    TCGOp *op;
+    intptr_t start, last;
+} PendingStore;
+
 typedef struct OptContext {
     TCGContext *tcg;
     TCGOp *prev_mb;
@@ -55,6 +81,15 @@ typedef struct OptContext {
     IntervalTreeRoot mem_copy;
     QSIMPLEQ_HEAD(, MemCopyInfo) mem_free;
 
+    CSEEntry *cse;
+    unsigned ebb;
+
+    PendingStore pending_st[MAX_PENDING_ST];
+    int nb_pending_st;
+
+    /* Statistics, see TCGOptStats. */
+    unsigned nb_ld_fwd, nb_cse, nb_dead_st;
+
     /* In flight values from optimization. */
     TCGType type;
     int carry_state;  /* -1 = non-constant, {0,1} = constant carry-in */
@@ -141,6 +176,7 @@ static void init_ts_info(OptContext *ctx, TCGTemp *ts)
 
     ti->next_copy = ts;
     ti->prev_copy = ts;
+    ti->version = 0;
     QSIMPLEQ_INIT(&ti->mem_copy);
     if (ts->kind == TEMP_CONST) {
         ti->z_mask = ts->val;
@@ -237,6 +273,7 @@ static void reset_ts(OptContext *ctx, TCGTemp *ts)
     ti->z_mask = -1;
     ti->o_mask = 0;
     ti->s_mask = 0;
+    ti->version++;
 
     if (!QSIMPLEQ_EMPTY(&ti->mem_copy)) {
         if (ts == nts) {
@@ -847,10 +884,138 @@ static void copy_propagate(OptContext *ctx, TCGOp *op,
     }
 }
 
+/*
+ * Dead store elimination.  A store to env is dead if a later store
+ * covers it before anything may read env: a load from env overlapping
+ * it, or any op that may look at env or leave the basic block.
+ */
+static void env_st_barrier(OptContext *ctx)
+{
+    ctx->nb_pending_st = 0;
+}
+
+static void env_st_read(OptContext *ctx, intptr_t start, intptr_t last)
+{
+    int i, j;
+
+    for (i = j = 0; i < ctx->nb_pending_st; i++) {
+        PendingStore *p = &ctx->pending_st[i];
+
+        if (p->last < start || p->start > last) {
+            ctx->pending_st[j++] = *p;
+        }
+    }
+    ctx->nb_pending_st = j;
+}
+
+static void env_st_write(OptContext *ctx, TCGOp *op,
+                         intptr_t start, intptr_t last)
+{
+    int i, j;
+
+    for (i = j = 0; i < ctx->nb_pending_st; i++) {
+        PendingStore *p = &ctx->pending_st[i];
+
+        if (start <= p->start && p->last <= last) {
+            tcg_op_remove(ctx->tcg, p->op);
+            ctx->nb_dead_st++;
+        } else {
+            ctx->pending_st[j++] = *p;
+        }
+    }
+    if (j == MAX_PENDING_ST) {
+        memmove(ctx->pending_st, ctx->pending_st + 1,
+                sizeof(PendingStore) * --j);
+    }
+    ctx->pending_st[j++] = (PendingStore){ op, start, last };
+    ctx->nb_pending_st = j;
+}
+
+/*
+ * Common subexpression elimination, within an extended basic block.
+ * Inputs are compared after copy propagation, together with the version
+ * of each input temp, so that an entry never matches once any of them,
+ * or its output, has been written again.
+ */
+static bool cse_eligible(const TCGOp *op, const TCGOpDef *def)
+{
+    switch (op->opc) {
+    case INDEX_op_ld8u:
+    case INDEX_op_ld8s:
+    case INDEX_op_ld16u:
+    case INDEX_op_ld16s:
+    case INDEX_op_ld32u:
+    case INDEX_op_ld32s:
+    case INDEX_op_ld:
+    case INDEX_op_ld_vec:
+    case INDEX_op_dupm_vec:
+        /* Memory is covered by the mem_copy tracking. */
+        return false;
+    default:
+        break;
+    }
+    return def->nb_oargs == 1 &&
+           def->nb_iargs + def->nb_cargs <= CSE_MAX_ARGS &&
+           !(def->flags & (TCG_OPF_BB_END | TCG_OPF_CALL_CLOBBER |
+                           TCG_OPF_SIDE_EFFECTS | TCG_OPF_NOT_PRESENT |
+                           TCG_OPF_CARRY_IN | TCG_OPF_CARRY_OUT));
+}
+
+static void cse_key(CSEEntry *key, const TCGOp *op, const TCGOpDef *def)
+{
+    int i, n = def->nb_iargs + def->nb_cargs;
+
+    memset(key, 0, sizeof(*key));
+    key->opc = op->opc;
+    key->param1 = op->param1;
+    key->param2 = op->param2;
+    for (i = 0; i < n; i++) {
+        key->args[i] = op->args[def->nb_oargs + i];
+    }
+    for (i = 0; i < def->nb_iargs; i++) {
+        key->version[i] = arg_info(key->args[i])->version;
+    }
+}
+
+static CSEEntry *cse_slot(OptContext *ctx, const CSEEntry *key)
+{
+    uint32_t h = key->opc ^ (key->param1 << 8) ^ (key->param2 << 16);
+
+    for (int i = 0; i < CSE_MAX_ARGS; i++) {
+        h = (h ^ (uint32_t)(key->args[i] >> 3)) * 0x9e3779b1u;
+    }
+    return &ctx->cse[h >> (32 - CSE_BITS)];
+}
+
+static TCGTemp *cse_lookup(OptContext *ctx, const CSEEntry *key)
+{
+    CSEEntry *e = cse_slot(ctx, key);
+
+    if (e->ebb != ctx->ebb || e->opc != key->opc ||
+        e->param1 != key->param1 || e->param2 != key->param2 ||
+        memcmp(e->args, key->args, sizeof(e->args)) ||
+        memcmp(e->version, key->version, sizeof(e->version)) ||
+        ts_info(e->out)->version != e->out_version) {
+        return NULL;
+    }
+    return e->out;
+}
+
+static void cse_record(OptContext *ctx, const CSEEntry *key, TCGTemp *out)
+{
+    CSEEntry *e = cse_slot(ctx, key);
+
+    *e = *key;
+    e->ebb = ctx->ebb;
+    e->out = out;
+    e->out_version = ts_info(out)->version;
+}
+
 static void finish_bb(OptContext *ctx)
 {
     /* We only optimize memory barriers across basic blocks. */
     ctx->prev_mb = NULL;
+    env_st_barrier(ctx);
 }
 
 static void finish_ebb(OptContext *ctx)
@@ -859,6 +1024,7 @@ static void finish_ebb(OptContext *ctx)
     /* We only optimize across extended basic blocks. */
     memset(&ctx->temps_used, 0, sizeof(ctx->temps_used));
     remove_mem_copy_all(ctx);
+    ctx->ebb++;
 }
 
 static bool finish_folding(OptContext *ctx, TCGOp *op)
@@ -1561,8 +1727,9 @@ static bool fold_call(OptContext *ctx, TCGOp *op)
         reset_temp(ctx, op->args[i]);
     }
 
-    /* Stop optimizing MB across calls. */
+    /* Stop optimizing MB across calls, which may also read env. */
     ctx->prev_mb = NULL;
+    env_st_barrier(ctx);
     return true;
 }
 
@@ -2889,30 +3056,44 @@ static bool fold_subbo(OptContext *ctx, TCGOp *op)
 static bool fold_tcg_ld(OptContext *ctx, TCGOp *op)
 {
     uint64_t z_mask = -1, s_mask = 0;
+    intptr_t lm1;
 
     /* We can't do any folding with a load, but we can record bits. */
     switch (op->opc) {
     case INDEX_op_ld8s:
         s_mask = INT8_MIN;
+        lm1 = 0;
         break;
     case INDEX_op_ld8u:
         z_mask = MAKE_64BIT_MASK(0, 8);
+        lm1 = 0;
         break;
     case INDEX_op_ld16s:
         s_mask = INT16_MIN;
+        lm1 = 1;
         break;
     case INDEX_op_ld16u:
         z_mask = MAKE_64BIT_MASK(0, 16);
+        lm1 = 1;
         break;
     case INDEX_op_ld32s:
         s_mask = INT32_MIN;
+        lm1 = 3;
         break;
     case INDEX_op_ld32u:
         z_mask = MAKE_64BIT_MASK(0, 32);
+        lm1 = 3;
         break;
     default:
         g_assert_not_reached();
     }
+
+    if (op->args[1] == tcgv_ptr_arg(tcg_env)) {
+        env_st_read(ctx, op->args[2], op->args[2] + lm1);
+    } else {
+        /* The pointer may well point into env. */
+        env_st_barrier(ctx);
+    }
     return fold_masks_zs(ctx, op, z_mask, s_mask);
 }
 
@@ -2923,6 +3104,7 @@ static bool fold_tcg_ld_memcopy(OptContext *ctx, TCGOp *op)
     TCGType type;
 
     if (op->args[1] != tcgv_ptr_arg(tcg_env)) {
+        env_st_barrier(ctx);
         return finish_folding(ctx, op);
     }
 
@@ -2931,9 +3113,11 @@ static bool fold_tcg_ld_memcopy(OptContext *ctx, TCGOp *op)
     dst = arg_temp(op->args[0]);
     src = find_mem_copy_for(ctx, type, ofs);
     if (src && src->base_type == type) {
+        ctx->nb_ld_fwd++;
         return tcg_opt_gen_mov(ctx, op, temp_arg(dst), temp_arg(src));
     }
 
+    env_st_read(ctx, ofs, ofs + tcg_type_size(type) - 1);
     reset_ts(ctx, dst);
     record_mem_copy(ctx, type, dst, ofs, ofs + tcg_type_size(type) - 1);
     return true;
@@ -2967,6 +3151,7 @@ static bool fold_tcg_st(OptContext *ctx, TCGOp *op)
         g_assert_not_reached();
     }
     remove_mem_copy_in(ctx, ofs, ofs + lm1);
+    env_st_write(ctx, op, ofs, ofs + lm1);
     return true;
 }
 
@@ -2999,6 +3184,7 @@ static bool fold_tcg_st_memcopy(OptContext *ctx, TCGOp *op)
     last = ofs + tcg_type_size(type) - 1;
     remove_mem_copy_in(ctx, ofs, last);
     record_mem_copy(ctx, type, src, ofs, last);
+    env_st_write(ctx, op, ofs, last);
     return true;
 }
 
@@ -3027,11 +3213,15 @@ static bool fold_xor(OptContext *ctx, TCGOp *op)
 /* Propagate constants and copies, fold constant expressions. */
 void tcg_optimize(TCGContext *s)
 {
-    int nb_temps, i;
+    int nb_temps, nb_ops, i;
     TCGOp *op, *op_next;
     OptContext ctx = { .tcg = s };
 
     QSIMPLEQ_INIT(&ctx.mem_free);
+    ctx.cse = tcg_malloc(sizeof(CSEEntry) << CSE_BITS);
+    memset(ctx.cse, 0, sizeof(CSEEntry) << CSE_BITS);
+    ctx.ebb = 1;
+    nb_ops = s->nb_ops;
 
     /* Array VALS has an element for each temp.
        If this temp holds a constant then its value is kept in VALS' element.
@@ -3046,6 +3236,8 @@ void tcg_optimize(TCGContext *s)
     QTAILQ_FOREACH_SAFE(op, &s->ops, link, op_next) {
         TCGOpcode opc = op->opc;
         const TCGOpDef *def;
+        CSEEntry key;
+        TCGTemp *cse_out = NULL;
         bool done = false;
 
         /* Calls are special. */
@@ -3061,6 +3253,26 @@ void tcg_optimize(TCGContext *s)
         /* Pre-compute the type of the operation. */
         ctx.type = TCGOP_TYPE(op);
 
+        if (def->flags & (TCG_OPF_BB_END | TCG_OPF_CALL_CLOBBER |
+                          TCG_OPF_SIDE_EFFECTS) ||
+            opc == INDEX_op_mb || opc == INDEX_op_dupm_vec ||
+            opc == INDEX_op_plugin_cb || opc == INDEX_op_plugin_mem_cb) {
+            env_st_barrier(&ctx);
+        }
+
+        if (cse_eligible(op, def)) {
+            TCGTemp *prev;
+
+            cse_key(&key, op, def);
+            prev = cse_lookup(&ctx, &key);
+            if (prev) {
+                ctx.nb_cse++;
+                tcg_opt_gen_mov(&ctx, op, op->args[0], temp_arg(prev));
+                continue;
+            }
+            cse_out = arg_temp(op->args[0]);
+        }
+
         /*
          * Process each opcode.
          * Sorted alphabetically by opcode as much as possible.
@@ -3268,5 +3480,16 @@ void tcg_optimize(TCGContext *s)
             break;
         }
         tcg_debug_assert(done);
+
+        if (cse_out) {
+            cse_record(&ctx, &key, cse_out);
+        }
     }
+
+    qatomic_set(&s->opt_stats.ops_in, s->opt_stats.ops_in + nb_ops);
+    qatomic_set(&s->opt_stats.ops_out, s->opt_stats.ops_out + s->nb_ops);
+    qatomic_set(&s->opt_stats.ld_fwd, s->opt_stats.ld_fwd + ctx.nb_ld_fwd);
+    qatomic_set(&s->opt_stats.cse, s->opt_stats.cse + ctx.nb_cse);
+    qatomic_set(&s->opt_stats.dead_st,
+                s->opt_stats.dead_st + ctx.nb_dead_st);
 }
@@ -52,6 +52,17 @@ struct tcg_region_tree {
     /* padding to avoid false sharing is computed at run-time */
 };
 
+/*
+ * Per-region bookkeeping.  Regions are handed out in order; once none is
+ * free, the oldest region that no context is using can be evicted, see
+ * tcg_region_evict.
+ */
+struct tcg_region_info {
+    uint64_t gen; /* allocation order; 0 if the region is free */
+    size_t size_full; /* contribution to region.agg_size_full */
+    size_t evictions;
+};
+
 /*
  * We divide code_gen_buffer into equally-sized "regions" that TCG threads
  * dynamically allocate from as demand dictates. Given appropriate region
@@ -70,8 +81,9 @@ struct tcg_region_state {
     size_t total_size; /* size of entire buffer, >= n * stride */
 
     /* fields protected by the lock */
-    size_t current; /* current region index */
+    uint64_t gen; /* last allocation order handed out */
     size_t agg_size_full; /* aggregate size of full regions */
+    struct tcg_region_info *info;
 };
 
 static struct tcg_region_state region;
@@ -191,10 +203,23 @@ static void tcg_region_trees_init(void)
     }
 }
 
-static struct tcg_region_tree *tc_ptr_to_region_tree(const void *p)
+/* Return the index of the region containing @p, a pointer into the rw buffer */
+static size_t tcg_region_index(const void *p)
 {
-    size_t region_idx;
+    ptrdiff_t offset;
+
+    if (p < region.start_aligned) {
+        return 0;
+    }
+    offset = p - region.start_aligned;
+    if (offset > region.stride * (region.n - 1)) {
+        return region.n - 1;
+    }
+    return offset / region.stride;
+}
 
+static struct tcg_region_tree *tc_ptr_to_region_tree(const void *p)
+{
     /*
      * Like tcg_splitwx_to_rw, with no assert.  The pc may come from
      * a signal handler over which the caller has no control.
@@ -206,18 +231,7 @@ static struct tcg_region_tree *tc_ptr_to_region_tree(const void *p)
         }
     }
 
-    if (p < region.start_aligned) {
-        region_idx = 0;
-    } else {
-        ptrdiff_t offset = p - region.start_aligned;
-
-        if (offset > region.stride * (region.n - 1)) {
-            region_idx = region.n - 1;
-        } else {
-            region_idx = offset / region.stride;
-        }
-    }
-    return region_trees + region_idx * tree_size;
+    return region_trees + tcg_region_index(p) * tree_size;
 }
 
 void tcg_tb_insert(TranslationBlock *tb)
@@ -311,6 +325,13 @@ size_t tcg_nb_tbs(void)
     return nb_tbs;
 }
 
+static void tcg_region_tree_reset(struct tcg_region_tree *rt)
+{
+    /* Increment the refcount first so that destroy acts as a reset */
+    q_tree_ref(rt->tree);
+    q_tree_destroy(rt->tree);
+}
+
 static void tcg_region_tree_reset_all(void)
 {
     size_t i;
@@ -319,9 +340,7 @@ static void tcg_region_tree_reset_all(void)
     for (i = 0; i < region.n; i++) {
         struct tcg_region_tree *rt = region_trees + i * tree_size;
 
-        /* Increment the refcount first so that destroy acts as a reset */
-        q_tree_ref(rt->tree);
-        q_tree_destroy(rt->tree);
+        tcg_region_tree_reset(rt);
     }
     tcg_region_tree_unlock_all();
 }
@@ -359,12 +378,17 @@ static void tcg_region_assign(TCGContext *s, size_t curr_region)
 
 static bool tcg_region_alloc__locked(TCGContext *s)
 {
-    if (region.current == region.n) {
-        return true;
+    size_t i;
+
+    /* Hand out the free regions in order, starting with never-used ones */
+    for (i = 0; i < region.n; i++) {
+        if (region.info[i].gen == 0) {
+            tcg_region_assign(s, i);
+            region.info[i].gen = ++region.gen;
+            return false;
+        }
     }
-    tcg_region_assign(s, region.current);
-    region.current++;
-    return false;
+    return true;
 }
 
 /*
@@ -374,12 +398,14 @@ static bool tcg_region_alloc__locked(TCGContext *s)
 bool tcg_region_alloc(TCGContext *s)
 {
     bool err;
-    /* read the region size now; alloc__locked will overwrite it on success */
+    /* read the region now; alloc__locked will overwrite it on success */
     size_t size_full = s->code_gen_buffer_size;
+    size_t full = tcg_region_index(s->code_gen_buffer);
 
     qemu_mutex_lock(&region.lock);
     err = tcg_region_alloc__locked(s);
     if (!err) {
+        region.info[full].size_full = size_full - TCG_HIGHWATER;
         region.agg_size_full += size_full - TCG_HIGHWATER;
     }
     qemu_mutex_unlock(&region.lock);
@@ -410,7 +436,10 @@ void tcg_region_reset_all(void)
     unsigned int i;
 
     qemu_mutex_lock(&region.lock);
-    region.current = 0;
+    for (i = 0; i < region.n; i++) {
+        region.info[i].gen = 0;
+        region.info[i].size_full = 0;
+    }
     region.agg_size_full = 0;
 
     for (i = 0; i < n_ctxs; i++) {
@@ -422,35 +451,120 @@ void tcg_region_reset_all(void)
     tcg_region_tree_reset_all();
 }
 
+static bool tcg_region_in_use(size_t idx)
+{
+    unsigned int n_ctxs = qatomic_read(&tcg_cur_ctxs);
+    unsigned int i;
+
+    for (i = 0; i < n_ctxs; i++) {
+        const TCGContext *s = qatomic_read(&tcg_ctxs[i]);
+
+        if (tcg_region_index(s->code_gen_buffer) == idx) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static gboolean tcg_region_collect_tb(gpointer key, gpointer value,
+                                      gpointer data)
+{
+    g_ptr_array_add(data, value);
+    return false;
+}
+
+/*
+ * Evict the oldest full region: pass each of its TBs to @evict_tb, which
+ * must unlink it from everything that could reach its code, then make the
+ * region available again.  Call from a safe-work context.
+ * Returns false if there is no region that can be evicted.
+ */
+bool tcg_region_evict(void (*evict_tb)(TranslationBlock *tb))
+{
+    g_autoptr(GPtrArray) tbs = NULL;
+    struct tcg_region_tree *rt;
+    size_t i, victim = region.n;
+
+    qemu_mutex_lock(&region.lock);
+    for (i = 0; i < region.n; i++) {
+        if (region.info[i].gen == 0 || tcg_region_in_use(i)) {
+            continue;
+        }
+        if (victim == region.n ||
+            region.info[i].gen < region.info[victim].gen) {
+            victim = i;
+        }
+    }
+    qemu_mutex_unlock(&region.lock);
+
+    if (victim == region.n) {
+        return false;
+    }
+
+    rt = region_trees + victim * tree_size;
+    tbs = g_ptr_array_new();
+    qemu_mutex_lock(&rt->lock);
+    q_tree_foreach(rt->tree, tcg_region_collect_tb, tbs);
+    qemu_mutex_unlock(&rt->lock);
+
+    for (i = 0; i < tbs->len; i++) {
+        evict_tb(g_ptr_array_index(tbs, i));
+    }
+
+    qemu_mutex_lock(&rt->lock);
+    tcg_region_tree_reset(rt);
+    qemu_mutex_unlock(&rt->lock);
+
+    qemu_mutex_lock(&region.lock);
+    region.agg_size_full -= region.info[victim].size_full;
+    region.info[victim].size_full = 0;
+    region.info[victim].gen = 0;
+    region.info[victim].evictions++;
+    qemu_mutex_unlock(&region.lock);
+    return true;
+}
+
+size_t tcg_nb_regions(void)
+{
+    return region.n;
+}
+
+size_t tcg_region_evictions(size_t idx)
+{
+    size_t ret;
+
+    qemu_mutex_lock(&region.lock);
+    ret = region.info[idx].evictions;
+    qemu_mutex_unlock(&region.lock);
+    return ret;
+}
+
 static size_t tcg_n_regions(size_t tb_size, unsigned max_threads)
 {
-#ifdef CONFIG_USER_ONLY
-    return 1;
-#else
-    size_t n_regions;
+    size_t n_regions = tb_size / (2 * MiB);
 
     /*
-     * It is likely that some vCPUs will translate more code than others,
-     * so we first try to set more regions than threads, with those regions
-     * being of reasonable size. If that's not possible we make do by evenly
-     * dividing the code_gen_buffer among the vCPUs.
-     *
-     * Use a single region if all we have is one vCPU thread.
+     * With a single context (always the case for user-mode), still use a
+     * few regions of >= 2 MB: once the buffer is full, the oldest one can
+     * be evicted rather than flushing all of the translated code.
      */
     if (max_threads == 1) {
-        return 1;
+        return MAX(MIN(n_regions, 8), 1);
     }
 
     /*
+     * It is likely that some vCPUs will translate more code than others,
+     * so we first try to set more regions than threads, with those regions
+     * being of reasonable size. If that's not possible we make do by evenly
+     * dividing the code_gen_buffer among the vCPUs.
+     *
      * Try to have more regions than threads, with each region being >= 2 MB.
      * If we can't, then just allocate one region per vCPU thread.
      */
-    n_regions = tb_size / (2 * MiB);
     if (n_regions <= max_threads) {
         return max_threads;
     }
     return MIN(n_regions, max_threads * 8);
-#endif
 }
 
 /*
@@ -839,6 +953,7 @@ void tcg_region_init(size_t tb_size, int splitwx, unsigned max_threads)
     }
 
     tcg_region_trees_init();
+    region.info = g_new0(struct tcg_region_info, region.n);
 
     /*
      * Leave the initial context initialized to the first region.
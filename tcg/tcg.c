@@ -1286,6 +1286,22 @@ void tcg_register_thread(void)
 }
 #endif /* !CONFIG_USER_ONLY */
 
+void tcg_get_opt_stats(TCGOptStats *stats)
+{
+    unsigned int n_ctxs = qatomic_read(&tcg_cur_ctxs);
+
+    memset(stats, 0, sizeof(*stats));
+    for (unsigned int i = 0; i < n_ctxs; i++) {
+        const TCGContext *s = qatomic_read(&tcg_ctxs[i]);
+
+        stats->ops_in += qatomic_read(&s->opt_stats.ops_in);
+        stats->ops_out += qatomic_read(&s->opt_stats.ops_out);
+        stats->ld_fwd += qatomic_read(&s->opt_stats.ld_fwd);
+        stats->cse += qatomic_read(&s->opt_stats.cse);
+        stats->dead_st += qatomic_read(&s->opt_stats.dead_st);
+    }
+}
+
 /* pool based memory allocation */
 void *tcg_malloc_internal(TCGContext *s, int size)
 {
@@ -2048,6 +2064,29 @@ TCGv_ptr tcg_global_mem_new_ptr(TCGv_ptr reg, intptr_t off, const char *name)
     return temp_tcgv_ptr(ts);
 }
 
+static void tcg_global_set_flag_internal(TCGTemp *ts)
+{
+    TCGContext *s = tcg_ctx;
+    int n = s->nb_flag_globals;
+
+    /* Indirect globals are lowered by liveness_pass_2; keep it simple. */
+    tcg_debug_assert(ts->kind == TEMP_GLOBAL && !ts->indirect_reg);
+    tcg_debug_assert(n < TCG_MAX_FLAG_GLOBALS);
+
+    s->flag_globals[n] = temp_idx(ts);
+    s->nb_flag_globals = n + 1;
+}
+
+void tcg_global_set_flag_i32(TCGv_i32 v)
+{
+    tcg_global_set_flag_internal(tcgv_i32_temp(v));
+}
+
+void tcg_global_set_flag_i64(TCGv_i64 v)
+{
+    tcg_global_set_flag_internal(tcgv_i64_temp(v));
+}
+
 TCGTemp *tcg_temp_new_internal(TCGType type, TCGTempKind kind)
 {
     TCGContext *s = tcg_ctx;
@@ -3689,9 +3728,40 @@ static void la_func_end(TCGContext *s, int ng, int nt)
     }
 }
 
+/*
+ * liveness analysis: the flag globals which are dead on entry to @l,
+ * i.e. overwritten on every path before being read or synced.
+ * Only known for forward branches: the label must already have been
+ * visited by the backward walk, otherwise dead_flags is still zero.
+ */
+static uint32_t la_label_dead_flags(TCGContext *s, TCGOp *op)
+{
+    TCGLabel *l;
+    uint32_t dead = 0;
+
+    switch (op->opc) {
+    case INDEX_op_set_label:
+        l = arg_label(op->args[0]);
+        for (int i = 0; i < s->nb_flag_globals; ++i) {
+            if (s->temps[s->flag_globals[i]].state == TS_DEAD) {
+                dead |= 1u << i;
+            }
+        }
+        l->dead_flags = dead;
+        return dead;
+    case INDEX_op_br:
+        return arg_label(op->args[0])->dead_flags;
+    case INDEX_op_brcond:
+        return arg_label(op->args[3])->dead_flags;
+    default:
+        return 0;
+    }
+}
+
 /* liveness analysis: end of basic block: all temps are dead, globals
-   and local temps should be in memory. */
-static void la_bb_end(TCGContext *s, int ng, int nt)
+   and local temps should be in memory, except for flag globals that
+   are dead in the successor. */
+static void la_bb_end(TCGContext *s, int ng, int nt, uint32_t dead_flags)
 {
     int i;
 
@@ -3715,6 +3785,13 @@ static void la_bb_end(TCGContext *s, int ng, int nt)
         ts->state = state;
         la_reset_pref(ts);
     }
+    for (int i = 0; dead_flags; ++i, dead_flags >>= 1) {
+        if (dead_flags & 1) {
+            TCGTemp *ts = &s->temps[s->flag_globals[i]];
+            ts->state = TS_DEAD;
+            la_reset_pref(ts);
+        }
+    }
 }
 
 /* liveness analysis: sync globals back to memory.  */
@@ -3735,11 +3812,22 @@ static void la_global_sync(TCGContext *s, int ng)
 /*
  * liveness analysis: conditional branch: all temps are dead unless
  * explicitly live-across-conditional-branch, globals and local temps
- * should be synced.
+ * should be synced.  Flag globals dead at the branch target keep the
+ * state of the fall-through path.
  */
-static void la_bb_sync(TCGContext *s, int ng, int nt)
+static void la_bb_sync(TCGContext *s, int ng, int nt, uint32_t dead_flags)
 {
+    uintptr_t keep[TCG_MAX_FLAG_GLOBALS];
+
+    for (int i = 0; i < s->nb_flag_globals; ++i) {
+        keep[i] = s->temps[s->flag_globals[i]].state;
+    }
     la_global_sync(s, ng);
+    for (int i = 0; dead_flags; ++i, dead_flags >>= 1) {
+        if (dead_flags & 1) {
+            s->temps[s->flag_globals[i]].state = keep[i];
+        }
+    }
 
     for (int i = ng; i < nt; ++i) {
         TCGTemp *ts = &s->temps[i];
@@ -3895,6 +3983,14 @@ liveness_pass_1(TCGContext *s)
     /* ??? Should be redundant with the exit_tb that ends the TB.  */
     la_func_end(s, nb_globals, nb_temps);
 
+    if (s->nb_flag_globals) {
+        TCGLabel *l;
+
+        QSIMPLEQ_FOREACH(l, &s->labels, next) {
+            l->dead_flags = 0;
+        }
+    }
+
     s->carry_live = false;
     QTAILQ_FOREACH_REVERSE_SAFE(op, &s->ops, link, op_prev) {
         int nb_iargs, nb_oargs;
@@ -4187,10 +4283,12 @@ liveness_pass_1(TCGContext *s)
                 la_func_end(s, nb_globals, nb_temps);
             } else if (def->flags & TCG_OPF_COND_BRANCH) {
                 assert_carry_dead(s);
-                la_bb_sync(s, nb_globals, nb_temps);
+                la_bb_sync(s, nb_globals, nb_temps,
+                           la_label_dead_flags(s, op));
             } else if (def->flags & TCG_OPF_BB_END) {
                 assert_carry_dead(s);
-                la_bb_end(s, nb_globals, nb_temps);
+                la_bb_end(s, nb_globals, nb_temps,
+                          la_label_dead_flags(s, op));
             } else if (def->flags & TCG_OPF_SIDE_EFFECTS) {
                 assert_carry_dead(s);
                 la_global_sync(s, nb_globals);
@@ -4867,15 +4965,37 @@ static void tcg_reg_alloc_bb_end(TCGContext *s, TCGRegSet allocated_regs)
     save_globals(s, allocated_regs);
 }
 
+static bool flag_global_dead(TCGContext *s, TCGLabel *l, int idx)
+{
+    for (int i = 0; i < s->nb_flag_globals; i++) {
+        if (s->flag_globals[i] == idx) {
+            return l->dead_flags & (1u << i);
+        }
+    }
+    return false;
+}
+
 /*
  * At a conditional branch, we assume all temporaries are dead unless
  * explicitly live-across-conditional-branch; all globals and local
- * temps are synced to their location.
+ * temps are synced to their location, except for flag globals that
+ * are dead at the branch target.
  */
-static void tcg_reg_alloc_cbranch(TCGContext *s, TCGRegSet allocated_regs)
+static void tcg_reg_alloc_cbranch(TCGContext *s, TCGRegSet allocated_regs,
+                                  TCGLabel *l)
 {
     assert_carry_dead(s);
-    sync_globals(s, allocated_regs);
+    if (!l->dead_flags) {
+        sync_globals(s, allocated_regs);
+    } else {
+        for (int i = 0; i < s->nb_globals; i++) {
+            TCGTemp *ts = &s->temps[i];
+            tcg_debug_assert(ts->val_type != TEMP_VAL_REG
+                             || ts->kind == TEMP_FIXED
+                             || ts->mem_coherent
+                             || flag_global_dead(s, l, i));
+        }
+    }
 
     for (int i = s->nb_globals; i < s->nb_temps; i++) {
         TCGTemp *ts = &s->temps[i];
@@ -5397,7 +5517,8 @@ static void tcg_reg_alloc_op(TCGContext *s, const TCGOp *op)
     }
 
     if (def->flags & TCG_OPF_COND_BRANCH) {
-        tcg_reg_alloc_cbranch(s, i_allocated_regs);
+        tcg_reg_alloc_cbranch(s, i_allocated_regs,
+                              arg_label(op->args[def->nb_args - 1]));
     } else if (def->flags & TCG_OPF_BB_END) {
         tcg_reg_alloc_bb_end(s, i_allocated_regs);
     } else {
@@ -0,0 +1,157 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+/*
+ * Check AdvSIMD instructions that map onto TCG host vector opcodes
+ * (abs_vec, tst_vec and the cmpsel_vec based shifts) against a C model.
+ * Run with "-d out_asm" to inspect the generated code.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#define ARRAY_SIZE(X) (sizeof(X) / sizeof(*(X)))
+
+typedef union {
+    uint64_t d[2];
+    uint16_t h[8];
+    uint8_t b[16];
+} vreg;
+
+static const vreg vj = {
+    .d = { 0x8081828384858687ULL, 0xf0e0d0c07f010080ULL }
+};
+/* Byte lanes double as signed shift counts for ushl/sshl. */
+static const vreg vk = {
+    .d = { 0x0107f9fd08f80200ULL, 0xf70903fe05fb0640ULL }
+};
+
+#define TEST_INSN(NAME, INSN)                                      \
+static void run_##NAME(vreg *d)                                    \
+{                                                                  \
+    asm volatile("ldr q1, [%1]\n\t"                                \
+                 "ldr q2, [%2]\n\t"                                \
+                 INSN "\n\t"                                       \
+                 "str q0, [%0]\n\t"                                \
+                 : : "r"(d), "r"(&vj), "r"(&vk)                    \
+                 : "memory", "v0", "v1", "v2");                    \
+}
+
+TEST_INSN(abs_b, "abs v0.16b, v1.16b")
+TEST_INSN(abs_h, "abs v0.8h, v1.8h")
+TEST_INSN(cmtst_b, "cmtst v0.16b, v1.16b, v2.16b")
+TEST_INSN(cmtst_d, "cmtst v0.2d, v1.2d, v2.2d")
+TEST_INSN(ushl_b, "ushl v0.16b, v1.16b, v2.16b")
+TEST_INSN(sshl_b, "sshl v0.16b, v1.16b, v2.16b")
+TEST_INSN(ushl_h, "ushl v0.8h, v1.8h, v2.8h")
+TEST_INSN(sshl_h, "sshl v0.8h, v1.8h, v2.8h")
+
+static void ref_abs_b(vreg *d)
+{
+    for (int i = 0; i < 16; i++) {
+        int8_t x = vj.b[i];
+        d->b[i] = x < 0 ? -x : x;
+    }
+}
+
+static void ref_abs_h(vreg *d)
+{
+    for (int i = 0; i < 8; i++) {
+        int16_t x = vj.h[i];
+        d->h[i] = x < 0 ? -x : x;
+    }
+}
+
+static void ref_cmtst_b(vreg *d)
+{
+    for (int i = 0; i < 16; i++) {
+        d->b[i] = vj.b[i] & vk.b[i] ? 0xff : 0;
+    }
+}
+
+static void ref_cmtst_d(vreg *d)
+{
+    for (int i = 0; i < 2; i++) {
+        d->d[i] = vj.d[i] & vk.d[i] ? -1ULL : 0;
+    }
+}
+
+static int64_t ref_shl(int64_t x, int8_t sh, int bits, int sign)
+{
+    uint64_t mask = (1ULL << bits) - 1;
+
+    if (sign) {
+        x = (int64_t)((uint64_t)x << (64 - bits)) >> (64 - bits);
+    } else {
+        x &= mask;
+    }
+    if (sh >= bits) {
+        return 0;
+    } else if (sh >= 0) {
+        return ((uint64_t)x << sh) & mask;
+    } else if (-sh >= bits) {
+        return sign && x < 0 ? mask : 0;
+    }
+    return (x >> -sh) & mask;
+}
+
+static void ref_ushl_b(vreg *d)
+{
+    for (int i = 0; i < 16; i++) {
+        d->b[i] = ref_shl(vj.b[i], vk.b[i], 8, 0);
+    }
+}
+
+static void ref_sshl_b(vreg *d)
+{
+    for (int i = 0; i < 16; i++) {
+        d->b[i] = ref_shl(vj.b[i], vk.b[i], 8, 1);
+    }
+}
+
+static void ref_ushl_h(vreg *d)
+{
+    for (int i = 0; i < 8; i++) {
+        d->h[i] = ref_shl(vj.h[i], vk.h[i] & 0xff, 16, 0);
+    }
+}
+
+static void ref_sshl_h(vreg *d)
+{
+    for (int i = 0; i < 8; i++) {
+        d->h[i] = ref_shl(vj.h[i], vk.h[i] & 0xff, 16, 1);
+    }
+}
+
+static const struct {
+    const char *name;
+    void (*run)(vreg *d);
+    void (*ref)(vreg *d);
+} tests[] = {
+#define T(NAME) { #NAME, run_##NAME, ref_##NAME }
+    T(abs_b),
+    T(abs_h),
+    T(cmtst_b),
+    T(cmtst_d),
+    T(ushl_b),
+    T(sshl_b),
+    T(ushl_h),
+    T(sshl_h),
+#undef T
+};
+
+int main(void)
+{
+    for (int i = 0; i < ARRAY_SIZE(tests); i++) {
+        vreg got, exp;
+
+        tests[i].run(&got);
+        tests[i].ref(&exp);
+        if (memcmp(&got, &exp, sizeof(got))) {
+            printf("%s: got %016" PRIx64 "%016" PRIx64
+                   " expected %016" PRIx64 "%016" PRIx64 "\n",
+                   tests[i].name, got.d[1], got.d[0], exp.d[1], exp.d[0]);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+/*
+ * Check a conditionally executed A32 integer loop
+ *
+ * Each conditional instruction branches around itself, and the next
+ * compare overwrites all of NZCV; the flags should then not need to be
+ * stored to env at those branches. The result is checked against a C
+ * model.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#define N 4096
+
+typedef struct {
+    int32_t max, min;
+    uint32_t sum, carries;
+} result;
+
+static int32_t data[N];
+
+static void run_asm(result *r)
+{
+    int32_t max = INT32_MIN, min = INT32_MAX;
+    uint32_t sum = 0, carries = 0;
+    const int32_t *p = data;
+    int n = N;
+
+    asm volatile("1:\n\t"
+                 "ldr r4, [%[p]], #4\n\t"
+                 "cmp r4, %[max]\n\t"
+                 "movgt %[max], r4\n\t"
+                 "cmp r4, %[min]\n\t"
+                 "movlt %[min], r4\n\t"
+                 "adds %[sum], %[sum], r4\n\t"
+                 "addcs %[carries], %[carries], #1\n\t"
+                 "subs %[n], %[n], #1\n\t"
+                 "bne 1b\n\t"
+                 : [p] "+r"(p), [n] "+r"(n), [max] "+r"(max),
+                   [min] "+r"(min), [sum] "+r"(sum), [carries] "+r"(carries)
+                 : : "r4", "cc", "memory");
+
+    r->max = max;
+    r->min = min;
+    r->sum = sum;
+    r->carries = carries;
+}
+
+static void run_ref(result *r)
+{
+    r->max = INT32_MIN;
+    r->min = INT32_MAX;
+    r->sum = 0;
+    r->carries = 0;
+
+    for (int i = 0; i < N; i++) {
+        uint32_t old = r->sum;
+
+        r->max = data[i] > r->max ? data[i] : r->max;
+        r->min = data[i] < r->min ? data[i] : r->min;
+        r->sum += data[i];
+        r->carries += r->sum < old;
+    }
+}
+
+int main(void)
+{
+    uint32_t seed = 1;
+    result got, exp;
+
+    for (int i = 0; i < N; i++) {
+        seed = seed * 1103515245 + 12345;
+        data[i] = seed;
+    }
+
+    run_asm(&got);
+    run_ref(&exp);
+    if (got.max != exp.max || got.min != exp.min ||
+        got.sum != exp.sum || got.carries != exp.carries) {
+        printf("got max %" PRId32 " min %" PRId32 " sum %" PRIu32
+               " carries %" PRIu32 ", expected %" PRId32 " %" PRId32
+               " %" PRIu32 " %" PRIu32 "\n",
+               got.max, got.min, got.sum, got.carries,
+               exp.max, exp.min, exp.sum, exp.carries);
+        return 1;
+    }
+    return 0;
+}
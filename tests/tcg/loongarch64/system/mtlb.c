@@ -0,0 +1,97 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+/*
+ * Check the MTLB lookup path (tlbsrch/invtlb)
+ *
+ * All MTLB entries are filled with huge pages, then tlbsrch is issued
+ * for hitting and missing addresses, which is the same lookup that QEMU
+ * runs on every TLB refill. Invalidating one entry, then all of them,
+ * must be reflected by later lookups.
+ */
+
+#include <minilib.h>
+
+#define CSR_TLBIDX      0x10
+#define CSR_TLBEHI      0x11
+#define CSR_TLBELO0     0x12
+#define CSR_TLBELO1     0x13
+
+#define TLBIDX_NE       (1UL << 31)
+#define TLBIDX_PS_SHIFT 24
+
+#define MTLB_ENTRIES    64
+#define HUGE_PS         21
+#define VA_BASE         0x100000000UL
+
+#define csrwr(val, csr) \
+    ({ unsigned long __v = (val); \
+       asm volatile("csrwr %0, %1" : "+r"(__v) : "i"(csr) : "memory"); })
+
+#define csrrd(csr) \
+    ({ unsigned long __v; \
+       asm volatile("csrrd %0, %1" : "=r"(__v) : "i"(csr) : "memory"); \
+       __v; })
+
+static unsigned long page_va(int i)
+{
+    return VA_BASE + ((unsigned long)i << (HUGE_PS + 1));
+}
+
+static void fill_mtlb(void)
+{
+    /* V, D, PLV0, MAT=CC */
+    unsigned long lo = 0x1 | 0x2 | (1 << 4);
+
+    csrwr((unsigned long)HUGE_PS << TLBIDX_PS_SHIFT, CSR_TLBIDX);
+    for (int i = 0; i < MTLB_ENTRIES; i++) {
+        csrwr(page_va(i), CSR_TLBEHI);
+        csrwr(lo, CSR_TLBELO0);
+        csrwr(lo, CSR_TLBELO1);
+        asm volatile("tlbfill" ::: "memory");
+    }
+}
+
+static int tlbsrch_hits(unsigned long va)
+{
+    csrwr(va, CSR_TLBEHI);
+    asm volatile("tlbsrch" ::: "memory");
+    return !(csrrd(CSR_TLBIDX) & TLBIDX_NE);
+}
+
+static int check(int i, int hit)
+{
+    if (tlbsrch_hits(page_va(i)) != hit) {
+        ml_printf("FAIL: entry %d %s\n", i, hit ? "missed" : "hit");
+        return 1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    int i;
+
+    fill_mtlb();
+    for (i = 0; i < MTLB_ENTRIES; i++) {
+        if (check(i, 1) || check(i + MTLB_ENTRIES, 0)) {
+            return 1;
+        }
+    }
+
+    /* Drop the non-global entry of ASID 0 that maps page 1 */
+    asm volatile("invtlb 5, $r0, %0" : : "r"(page_va(1)) : "memory");
+    for (i = 0; i < MTLB_ENTRIES; i++) {
+        if (check(i, i != 1)) {
+            return 1;
+        }
+    }
+
+    asm volatile("invtlb 0, $r0, $r0" ::: "memory");
+    for (i = 0; i < MTLB_ENTRIES; i++) {
+        if (check(i, 0)) {
+            return 1;
+        }
+    }
+
+    ml_printf("PASS\n");
+    return 0;
+}
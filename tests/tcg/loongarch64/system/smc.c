@@ -0,0 +1,57 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+/*
+ * Check stores to pages holding translated code
+ *
+ * A small function is placed at the start of a page. Storing to data
+ * further into the same page, as a JIT does with its literal pools, must
+ * not change what it returns; patching the function before each call
+ * must always run the new code.
+ */
+
+#include <minilib.h>
+
+#define CALLS           64
+#define DATA_OFS        512
+
+/* addi.w $a0, $zero, imm; jirl $zero, $ra, 0 */
+#define ADDI_W_A0(imm)  (0x02800004 | (((imm) & 0xfff) << 10))
+#define JR_RA           0x4c000020
+
+static unsigned int page[1024] __attribute__((aligned(4096)));
+
+static long call(void)
+{
+    return ((long (*)(void))page)();
+}
+
+static void patch(int imm)
+{
+    page[0] = ADDI_W_A0(imm);
+    page[1] = JR_RA;
+    asm volatile("ibar 0" ::: "memory");
+}
+
+int main(void)
+{
+    volatile unsigned int *data = &page[DATA_OFS];
+
+    patch(1);
+    for (int n = 0; n < CALLS; n++) {
+        *data = n;
+        if (call() != 1) {
+            ml_printf("FAIL: data store %d changed the code\n", n);
+            return 1;
+        }
+    }
+
+    for (int n = 0; n < CALLS; n++) {
+        patch(n);
+        if (call() != n) {
+            ml_printf("FAIL: patch %d ran stale code\n", n);
+            return 1;
+        }
+    }
+
+    ml_printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,48 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+/*
+ * Forward direct branches are translated without ending the TB;
+ * check that skipped words are not executed and that bl links.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+
+static uint64_t test_b(uint64_t x)
+{
+    asm volatile("addi.d %0, %0, 1\n\t"
+                 "b 1f\n\t"
+                 ".word 0\n\t"              /* would raise INE */
+                 "addi.d %0, %0, 0x10\n\t"
+                 "1:\n\t"
+                 "addi.d %0, %0, 0x100\n\t"
+                 "b 2f\n\t"
+                 "addi.d %0, %0, 0x20\n\t"
+                 "2:\n\t"
+                 : "+r"(x));
+    return x;
+}
+
+static void test_bl(uint64_t *ra, uint64_t *expect)
+{
+    asm volatile("move $t0, $ra\n\t"
+                 "bl 1f\n\t"
+                 ".word 0\n\t"
+                 "1:\n\t"
+                 "move %0, $ra\n\t"
+                 "pcaddi %1, 0\n\t"
+                 "addi.d %1, %1, -8\n\t"
+                 "move $ra, $t0\n\t"
+                 : "=r"(*ra), "=r"(*expect)
+                 : : "t0");
+}
+
+int main(void)
+{
+    uint64_t ra, expect;
+
+    assert(test_b(0) == 0x101);
+
+    test_bl(&ra, &expect);
+    assert(ra == expect);
+    return 0;
+}
@@ -11,5 +11,41 @@ int main()
         : "=r"(fcsr) : : "f0");
 
     assert(fcsr & (16 << 16)); /* Invalid */
+
+    /* Clearing Flags through FCSR2 must also drop the unfolded ones */
+    asm("movgr2fcsr $r0,$r0\n\t"
+        "movgr2fr.d $f0,$r0\n\t"
+        "fdiv.d     $f0,$f0,$f0\n\t"
+        "movgr2fcsr $r2,$r0\n\t"
+        "movfcsr2gr %0,$r0"
+        : "=r"(fcsr) : : "f0");
+
+    assert(!(fcsr & (16 << 16)));
+
+    /* An exact operation must not report Inexact in Cause */
+    asm("movgr2fcsr $r0,%1\n\t"
+        "movgr2fr.d $f0,%2\n\t"
+        "fadd.d     $f0,$f0,$f0\n\t"
+        "movfcsr2gr %0,$r0"
+        : "=r"(fcsr) : "r"(1 << 16), "r"(0x3ff0000000000000ULL) : "f0");
+
+    assert(fcsr & (1 << 16));     /* Inexact in Flags */
+    assert(!(fcsr & (1 << 24)));  /* but not in Cause */
+
+    /* Inexact results must not depend on Inexact being recorded already */
+    for (int i = 0; i < 2; i++) {
+        volatile double x = 1.0, y = 3.0;
+        double d;
+
+        asm("movgr2fcsr $r0,%2
+	"
+            "fdiv.d     %0,%3,%4
+	"
+            "movfcsr2gr %1,$r0"
+            : "=f"(d), "=r"(fcsr) : "r"(i << 16), "f"(x), "f"(y));
+
+        assert(d == x / y);
+        assert(fcsr & (1 << 16));
+    }
     return 0;
 }
@@ -0,0 +1,233 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+/*
+ * Check LSX instructions that are expanded inline by TCG against a
+ * C model.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#define ARRAY_SIZE(X) (sizeof(X) / sizeof(*(X)))
+
+typedef union {
+    uint64_t d[2];
+    uint32_t w[4];
+    uint16_t h[8];
+    uint8_t b[16];
+} vreg;
+
+static const vreg vj = { .d = { 0x8081828384858687ULL, 0xf0e0d0c0b0a09080ULL } };
+static const vreg vk = { .d = { 0x0123456789abcdefULL, 0xfedcba9876543210ULL } };
+
+#define TEST_INSN(NAME, INSN)                                      \
+static void run_##NAME(vreg *d)                                    \
+{                                                                  \
+    asm volatile("vld $vr1, %1, 0\n\t"                             \
+                 "vld $vr2, %2, 0\n\t"                             \
+                 INSN "\n\t"                                       \
+                 "vst $vr0, %0, 0\n\t"                             \
+                 : : "r"(d), "r"(&vj), "r"(&vk)                    \
+                 : "memory", "f0", "f1", "f2");                    \
+}
+
+TEST_INSN(vpcnt_b, "vpcnt.b $vr0, $vr1")
+TEST_INSN(vpcnt_h, "vpcnt.h $vr0, $vr1")
+TEST_INSN(vpcnt_w, "vpcnt.w $vr0, $vr1")
+TEST_INSN(vpcnt_d, "vpcnt.d $vr0, $vr1")
+TEST_INSN(vilvl_w, "vilvl.w $vr0, $vr1, $vr2")
+TEST_INSN(vilvl_d, "vilvl.d $vr0, $vr1, $vr2")
+TEST_INSN(vilvh_w, "vilvh.w $vr0, $vr1, $vr2")
+TEST_INSN(vilvh_d, "vilvh.d $vr0, $vr1, $vr2")
+TEST_INSN(vpickev_w, "vpickev.w $vr0, $vr1, $vr2")
+TEST_INSN(vpickev_d, "vpickev.d $vr0, $vr1, $vr2")
+TEST_INSN(vpickod_w, "vpickod.w $vr0, $vr1, $vr2")
+TEST_INSN(vpickod_d, "vpickod.d $vr0, $vr1, $vr2")
+TEST_INSN(vsllwil_h_b, "vsllwil.h.b $vr0, $vr1, 3")
+TEST_INSN(vsllwil_w_h, "vsllwil.w.h $vr0, $vr1, 5")
+TEST_INSN(vsllwil_d_w, "vsllwil.d.w $vr0, $vr1, 7")
+TEST_INSN(vsllwil_hu_bu, "vsllwil.hu.bu $vr0, $vr1, 3")
+TEST_INSN(vsllwil_wu_hu, "vsllwil.wu.hu $vr0, $vr1, 5")
+TEST_INSN(vsllwil_du_wu, "vsllwil.du.wu $vr0, $vr1, 7")
+TEST_INSN(vextl_q_d, "vextl.q.d $vr0, $vr1")
+TEST_INSN(vextl_qu_du, "vextl.qu.du $vr0, $vr1")
+
+static void ref_vpcnt(vreg *d, int bits)
+{
+    int i, n = 128 / bits;
+
+    memset(d, 0, sizeof(*d));
+    for (i = 0; i < n; i++) {
+        int bit;
+
+        for (bit = i * bits; bit < (i + 1) * bits; bit++) {
+            if (vj.b[bit / 8] & (1 << (bit % 8))) {
+                switch (bits) {
+                case 8:
+                    d->b[i]++;
+                    break;
+                case 16:
+                    d->h[i]++;
+                    break;
+                case 32:
+                    d->w[i]++;
+                    break;
+                default:
+                    d->d[i]++;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+static void ref_vpcnt_b(vreg *d) { ref_vpcnt(d, 8); }
+static void ref_vpcnt_h(vreg *d) { ref_vpcnt(d, 16); }
+static void ref_vpcnt_w(vreg *d) { ref_vpcnt(d, 32); }
+static void ref_vpcnt_d(vreg *d) { ref_vpcnt(d, 64); }
+
+static void ref_vilvl_w(vreg *d)
+{
+    d->w[0] = vk.w[0];
+    d->w[1] = vj.w[0];
+    d->w[2] = vk.w[1];
+    d->w[3] = vj.w[1];
+}
+
+static void ref_vilvh_w(vreg *d)
+{
+    d->w[0] = vk.w[2];
+    d->w[1] = vj.w[2];
+    d->w[2] = vk.w[3];
+    d->w[3] = vj.w[3];
+}
+
+static void ref_vpickev_w(vreg *d)
+{
+    d->w[0] = vk.w[0];
+    d->w[1] = vk.w[2];
+    d->w[2] = vj.w[0];
+    d->w[3] = vj.w[2];
+}
+
+static void ref_vpickod_w(vreg *d)
+{
+    d->w[0] = vk.w[1];
+    d->w[1] = vk.w[3];
+    d->w[2] = vj.w[1];
+    d->w[3] = vj.w[3];
+}
+
+static void ref_vilvl_d(vreg *d)
+{
+    d->d[0] = vk.d[0];
+    d->d[1] = vj.d[0];
+}
+
+static void ref_vilvh_d(vreg *d)
+{
+    d->d[0] = vk.d[1];
+    d->d[1] = vj.d[1];
+}
+
+static void ref_vsllwil_h_b(vreg *d)
+{
+    for (int i = 0; i < 8; i++) {
+        d->h[i] = (int16_t)(int8_t)vj.b[i] << 3;
+    }
+}
+
+static void ref_vsllwil_w_h(vreg *d)
+{
+    for (int i = 0; i < 4; i++) {
+        d->w[i] = (int32_t)(int16_t)vj.h[i] << 5;
+    }
+}
+
+static void ref_vsllwil_d_w(vreg *d)
+{
+    for (int i = 0; i < 2; i++) {
+        d->d[i] = (int64_t)(int32_t)vj.w[i] << 7;
+    }
+}
+
+static void ref_vsllwil_hu_bu(vreg *d)
+{
+    for (int i = 0; i < 8; i++) {
+        d->h[i] = (uint16_t)vj.b[i] << 3;
+    }
+}
+
+static void ref_vsllwil_wu_hu(vreg *d)
+{
+    for (int i = 0; i < 4; i++) {
+        d->w[i] = (uint32_t)vj.h[i] << 5;
+    }
+}
+
+static void ref_vsllwil_du_wu(vreg *d)
+{
+    for (int i = 0; i < 2; i++) {
+        d->d[i] = (uint64_t)vj.w[i] << 7;
+    }
+}
+
+static void ref_vextl_q_d(vreg *d)
+{
+    d->d[0] = vj.d[0];
+    d->d[1] = (int64_t)vj.d[0] >> 63;
+}
+
+static void ref_vextl_qu_du(vreg *d)
+{
+    d->d[0] = vj.d[0];
+    d->d[1] = 0;
+}
+
+static const struct {
+    const char *name;
+    void (*run)(vreg *d);
+    void (*ref)(vreg *d);
+} tests[] = {
+#define T(NAME, REF) { #NAME, run_##NAME, ref_##REF }
+    T(vpcnt_b, vpcnt_b),
+    T(vpcnt_h, vpcnt_h),
+    T(vpcnt_w, vpcnt_w),
+    T(vpcnt_d, vpcnt_d),
+    T(vilvl_w, vilvl_w),
+    T(vilvl_d, vilvl_d),
+    T(vilvh_w, vilvh_w),
+    T(vilvh_d, vilvh_d),
+    T(vpickev_w, vpickev_w),
+    T(vpickev_d, vilvl_d),
+    T(vpickod_w, vpickod_w),
+    T(vpickod_d, vilvh_d),
+    T(vsllwil_h_b, vsllwil_h_b),
+    T(vsllwil_w_h, vsllwil_w_h),
+    T(vsllwil_d_w, vsllwil_d_w),
+    T(vsllwil_hu_bu, vsllwil_hu_bu),
+    T(vsllwil_wu_hu, vsllwil_wu_hu),
+    T(vsllwil_du_wu, vsllwil_du_wu),
+    T(vextl_q_d, vextl_q_d),
+    T(vextl_qu_du, vextl_qu_du),
+#undef T
+};
+
+int main(void)
+{
+    int i;
+
+    for (i = 0; i < ARRAY_SIZE(tests); i++) {
+        vreg got, exp;
+
+        tests[i].run(&got);
+        tests[i].ref(&exp);
+        if (memcmp(&got, &exp, sizeof(got))) {
+            printf("%s: got %016" PRIx64 "%016" PRIx64
+                   " expected %016" PRIx64 "%016" PRIx64 "\n",
+                   tests[i].name, got.d[1], got.d[0], exp.d[1], exp.d[0]);
+            return 1;
+        }
+    }
+    return 0;
+}
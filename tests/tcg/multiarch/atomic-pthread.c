@@ -0,0 +1,105 @@
+/*
+ * Atomic operations exerciser
+ *
+ * Hammer shared counters with a mix of atomic read-modify-write
+ * operations, first from a single thread, where QEMU may emulate them
+ * non-atomically, and then from several threads at once. The counters
+ * must end up with the expected values either way.
+ *
+ * It is also run with memory access instrumentation, which is injected
+ * in the middle of the sequences emitted for those operations.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NR_THREADS 4
+#define NR_ITERS 20000
+
+static uint8_t count8;
+static uint16_t count16;
+static uint32_t count32;
+static unsigned long count_cas;
+static unsigned long count_xchg;
+static unsigned long mask;
+
+static void hammer(int id)
+{
+    for (int i = 0; i < NR_ITERS; i++) {
+        unsigned long old, seen;
+
+        __atomic_fetch_add(&count8, 1, __ATOMIC_SEQ_CST);
+        __atomic_fetch_add(&count16, 1, __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&count32, 1, __ATOMIC_SEQ_CST);
+
+        old = __atomic_load_n(&count_cas, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&count_cas, &old, old + 1, false,
+                                            __ATOMIC_SEQ_CST,
+                                            __ATOMIC_RELAXED)) {
+            /* old was updated with the current value: retry */
+        }
+
+        /* Take the counter, add one and give it back. */
+        do {
+            seen = __atomic_exchange_n(&count_xchg, -1UL, __ATOMIC_SEQ_CST);
+        } while (seen == -1UL);
+        __atomic_store_n(&count_xchg, seen + 1, __ATOMIC_SEQ_CST);
+
+        __atomic_fetch_or(&mask, 1UL << id, __ATOMIC_SEQ_CST);
+        __atomic_fetch_and(&mask, ~(1UL << (id + NR_THREADS)),
+                           __ATOMIC_SEQ_CST);
+    }
+}
+
+static void check(int runs)
+{
+    unsigned long total = (unsigned long)runs * NR_ITERS;
+
+    if (count8 != (uint8_t)total || count16 != (uint16_t)total ||
+        count32 != (uint32_t)total || count_cas != total ||
+        count_xchg != total) {
+        fprintf(stderr, "after %d runs: %u %u %u %lu %lu, expected %lu\n",
+                runs, count8, count16, count32, count_cas, count_xchg,
+                total);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void *thread_fn(void *arg)
+{
+    hammer((intptr_t)arg);
+    return NULL;
+}
+
+int main(void)
+{
+    pthread_t threads[NR_THREADS];
+    unsigned long all = (1UL << NR_THREADS) - 1;
+
+    mask = all << NR_THREADS;
+
+    /* No other thread exists yet. */
+    hammer(0);
+    check(1);
+
+    for (intptr_t i = 0; i < NR_THREADS; i++) {
+        int ret = pthread_create(&threads[i], NULL, thread_fn, (void *)i);
+        assert(ret == 0);
+    }
+    for (int i = 0; i < NR_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    check(1 + NR_THREADS);
+
+    if (mask != all) {
+        fprintf(stderr, "mask: %#lx, expected %#lx\n", mask, all);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,290 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+/*
+ * Check io_uring submission and completion
+ *
+ * The rings are driven by hand the way liburing does it: SQEs are
+ * queued in batches, each batch is handed over with one io_uring_enter
+ * and its completions are reaped from the CQ ring.  Writes and readv
+ * of a temporary file, polling a pipe, and rings used through duplicated
+ * fds are checked.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__NR_io_uring_setup) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+
+#define ENTRIES     64
+#define BLOCK       4096
+
+struct ring {
+    int fd;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    unsigned sqe_tail;
+};
+
+static char buf[ENTRIES][BLOCK];
+
+/* Set up a ring; with @dup_fd, only map and use a duplicate of its fd. */
+static int ring_init(struct ring *r, bool dup_fd)
+{
+    struct io_uring_params p;
+    size_t sq_size, cq_size;
+    char *sq, *cq;
+
+    memset(&p, 0, sizeof(p));
+    r->fd = syscall(__NR_io_uring_setup, ENTRIES, &p);
+    if (r->fd < 0) {
+        return -errno;
+    }
+    if (dup_fd) {
+        int fd = dup(r->fd);
+
+        assert(fd >= 0);
+        close(r->fd);
+        r->fd = fd;
+    }
+
+    sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        sq_size = cq_size = sq_size > cq_size ? sq_size : cq_size;
+    }
+    sq = mmap(NULL, sq_size, PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+    assert(sq != MAP_FAILED);
+    cq = sq;
+    if (!(p.features & IORING_FEAT_SINGLE_MMAP)) {
+        cq = mmap(NULL, cq_size, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+        assert(cq != MAP_FAILED);
+    }
+    r->sqes = mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe),
+                   PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   r->fd, IORING_OFF_SQES);
+    assert(r->sqes != MAP_FAILED);
+
+    r->sq_head = (unsigned *)(sq + p.sq_off.head);
+    r->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    r->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned *)(sq + p.sq_off.array);
+    r->cq_head = (unsigned *)(cq + p.cq_off.head);
+    r->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    r->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    r->sqe_tail = *r->sq_tail;
+    assert(*r->sq_mask == p.sq_entries - 1);
+    return 0;
+}
+
+static struct io_uring_sqe *get_sqe(struct ring *r, int op, int fd,
+                                    void *addr, unsigned len, uint64_t off,
+                                    uint64_t user_data)
+{
+    unsigned idx = r->sqe_tail++ & *r->sq_mask;
+    struct io_uring_sqe *sqe = &r->sqes[idx];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = op;
+    sqe->fd = fd;
+    sqe->addr = (uintptr_t)addr;
+    sqe->len = len;
+    sqe->off = off;
+    sqe->user_data = user_data;
+    r->sq_array[idx] = idx;
+    return sqe;
+}
+
+/* Submit all queued SQEs and wait for as many completions. */
+static void submit_and_wait(struct ring *r, unsigned n)
+{
+    int ret;
+
+    __atomic_store_n(r->sq_tail, r->sqe_tail, __ATOMIC_RELEASE);
+    ret = syscall(__NR_io_uring_enter, r->fd, n, n,
+                  IORING_ENTER_GETEVENTS, NULL, 0);
+    assert(ret == n);
+}
+
+/* Reap @n completions, checking each against @check. */
+static void reap(struct ring *r, unsigned n,
+                 void (*check)(struct io_uring_cqe *cqe))
+{
+    unsigned head = *r->cq_head;
+
+    while (n--) {
+        assert(head != __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE));
+        check(&r->cqes[head++ & *r->cq_mask]);
+    }
+    __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+}
+
+static void check_nop(struct io_uring_cqe *cqe)
+{
+    assert(cqe->res == 0);
+    assert(cqe->user_data == 0x0123456789abcdefull);
+}
+
+static void check_block(struct io_uring_cqe *cqe)
+{
+    assert(cqe->res == BLOCK);
+    assert(cqe->user_data < ENTRIES);
+}
+
+static void check_einval(struct io_uring_cqe *cqe)
+{
+    assert(cqe->res == -EINVAL);
+    assert(cqe->user_data == 42);
+}
+
+static void check_pollin(struct io_uring_cqe *cqe)
+{
+    assert(cqe->res & POLLIN);
+    assert(cqe->user_data == 7);
+}
+
+static void test_file(struct ring *r, int fd)
+{
+    struct iovec iov[ENTRIES];
+    int i, j;
+
+    for (i = 0; i < ENTRIES; i++) {
+        memset(buf[i], 'a' + i % 26, BLOCK);
+        get_sqe(r, IORING_OP_WRITE, fd, buf[i], BLOCK,
+                (uint64_t)i * BLOCK, i);
+    }
+    submit_and_wait(r, ENTRIES);
+    reap(r, ENTRIES, check_block);
+
+    memset(buf, 0, sizeof(buf));
+    for (i = 0; i < ENTRIES; i++) {
+        iov[i].iov_base = buf[ENTRIES - 1 - i];
+        iov[i].iov_len = BLOCK;
+        get_sqe(r, IORING_OP_READV, fd, &iov[i], 1,
+                (uint64_t)i * BLOCK, i);
+    }
+    submit_and_wait(r, ENTRIES);
+    reap(r, ENTRIES, check_block);
+
+    for (i = 0; i < ENTRIES; i++) {
+        for (j = 0; j < BLOCK; j++) {
+            assert(buf[ENTRIES - 1 - i][j] == 'a' + i % 26);
+        }
+    }
+}
+
+static void test_invalid(struct ring *r)
+{
+    int ret;
+
+    /* An unknown opcode completes with -EINVAL. */
+    get_sqe(r, 0xff, -1, NULL, 0, 0, 42);
+    __atomic_store_n(r->sq_tail, r->sqe_tail, __ATOMIC_RELEASE);
+    ret = syscall(__NR_io_uring_enter, r->fd, 1, 1,
+                  IORING_ENTER_GETEVENTS, NULL, 0);
+    assert(ret == 1);
+    reap(r, 1, check_einval);
+}
+
+static void test_nop(struct ring *r)
+{
+    int i;
+
+    for (i = 0; i < ENTRIES; i++) {
+        get_sqe(r, IORING_OP_NOP, -1, NULL, 0, 0, 0x0123456789abcdefull);
+    }
+    submit_and_wait(r, ENTRIES);
+    reap(r, ENTRIES, check_nop);
+}
+
+static void test_poll(struct ring *r)
+{
+    struct io_uring_sqe *sqe;
+    int pipefd[2];
+    uint32_t events = POLLIN;
+
+    assert(pipe(pipefd) == 0);
+    assert(write(pipefd[1], "x", 1) == 1);
+
+    /* 32-bit poll masks are stored word-swapped on big-endian. */
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    events = events << 16 | events >> 16;
+#endif
+    sqe = get_sqe(r, IORING_OP_POLL_ADD, pipefd[0], NULL, 0, 0, 7);
+    sqe->poll32_events = events;
+    submit_and_wait(r, 1);
+    reap(r, 1, check_pollin);
+
+    close(pipefd[0]);
+    close(pipefd[1]);
+}
+
+/* The ring must keep working through a duplicate of its fd alone. */
+static void test_dup(void)
+{
+    struct ring r;
+    int fd;
+
+    assert(ring_init(&r, true) == 0);
+    test_nop(&r);
+
+    fd = fcntl(r.fd, F_DUPFD_CLOEXEC, 0);
+    assert(fd >= 0);
+    close(r.fd);
+    r.fd = fd;
+    test_nop(&r);
+    close(r.fd);
+}
+
+int main(void)
+{
+    char tempname[] = "/tmp/.io_uringXXXXXX";
+    struct ring r;
+    int ret, fd;
+
+    ret = ring_init(&r, false);
+    if (ret == -ENOSYS || ret == -EPERM) {
+        printf("io_uring not available, skipping\n");
+        return EXIT_SUCCESS;
+    }
+    assert(ret == 0);
+
+    fd = mkstemp(tempname);
+    assert(fd != -1);
+    unlink(tempname);
+
+    test_file(&r, fd);
+    test_invalid(&r);
+    test_nop(&r);
+    test_poll(&r);
+    test_dup();
+
+    close(fd);
+    close(r.fd);
+    return EXIT_SUCCESS;
+}
+
+#else
+
+int main(void)
+{
+    printf("io_uring headers not available, skipping\n");
+    return EXIT_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,186 @@
+/*
+ * Demonstrates, tests and times record buffers.
+ *
+ * Every instruction and memory access is counted both with inline ops
+ * and from the records handed to the plugin in batches, which must
+ * agree. With callback=true, regular callbacks are used instead of
+ * record ops, to compare the time taken.
+ *
+ * License: GNU GPL, version 2 or later.
+ *   See the COPYING file in the top-level directory.
+ */
+
+#include <glib.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <qemu-plugin.h>
+
+typedef struct {
+    uint64_t insn_inline;
+    uint64_t mem_inline;
+    uint64_t insn;
+    uint64_t mem;
+    uint64_t batches;
+} CPUCount;
+
+static struct qemu_plugin_scoreboard *counts;
+static qemu_plugin_u64 insn_inline;
+static qemu_plugin_u64 mem_inline;
+static qemu_plugin_u64 insn_count;
+static qemu_plugin_u64 mem_count;
+static qemu_plugin_u64 batches;
+
+static struct qemu_plugin_record_buffer *records;
+static size_t buffer_size = 1024;
+static bool do_callback;
+static gint64 start_time;
+
+QEMU_PLUGIN_EXPORT int qemu_plugin_version = QEMU_PLUGIN_VERSION;
+
+static void vcpu_records(unsigned int cpu_index,
+                         const qemu_plugin_record *r, size_t n,
+                         void *udata)
+{
+    uint64_t insn = 0, mem = 0;
+
+    g_assert(n <= buffer_size);
+    for (size_t i = 0; i < n; i++) {
+        if (r[i].info) {
+            mem++;
+        } else {
+            /* Instruction records carry their address as data. */
+            g_assert(r[i].data == r[i].vaddr);
+            insn++;
+        }
+    }
+    qemu_plugin_u64_add(insn_count, cpu_index, insn);
+    qemu_plugin_u64_add(mem_count, cpu_index, mem);
+    qemu_plugin_u64_add(batches, cpu_index, 1);
+}
+
+static void vcpu_insn_exec(unsigned int cpu_index, void *udata)
+{
+    qemu_plugin_u64_add(insn_count, cpu_index, 1);
+}
+
+static void vcpu_mem_access(unsigned int cpu_index,
+                            qemu_plugin_meminfo_t info,
+                            uint64_t vaddr, void *udata)
+{
+    qemu_plugin_u64_add(mem_count, cpu_index, 1);
+}
+
+static void vcpu_tb_trans(struct qemu_plugin_tb *tb, void *udata)
+{
+    size_t n_insns = qemu_plugin_tb_n_insns(tb);
+
+    for (size_t i = 0; i < n_insns; i++) {
+        struct qemu_plugin_insn *insn = qemu_plugin_tb_get_insn(tb, i);
+        uint64_t vaddr = qemu_plugin_insn_vaddr(insn);
+
+        qemu_plugin_register_vcpu_insn_exec_inline_per_vcpu(
+            insn, QEMU_PLUGIN_INLINE_ADD_U64, insn_inline, 1);
+        qemu_plugin_register_vcpu_mem_inline_per_vcpu(
+            insn, QEMU_PLUGIN_MEM_RW, QEMU_PLUGIN_INLINE_ADD_U64,
+            mem_inline, 1);
+
+        if (do_callback) {
+            qemu_plugin_register_vcpu_insn_exec_cb(
+                insn, vcpu_insn_exec, QEMU_PLUGIN_CB_NO_REGS, NULL);
+            qemu_plugin_register_vcpu_mem_cb(
+                insn, vcpu_mem_access, QEMU_PLUGIN_CB_NO_REGS,
+                QEMU_PLUGIN_MEM_RW, NULL);
+        } else {
+            qemu_plugin_register_vcpu_insn_exec_record(insn, records, vaddr);
+            qemu_plugin_register_vcpu_mem_record(insn, records,
+                                                 QEMU_PLUGIN_MEM_RW, vaddr);
+        }
+    }
+}
+
+static void plugin_exit(qemu_plugin_id_t id, void *udata)
+{
+    const unsigned int num_cpus = qemu_plugin_num_vcpus();
+    gint64 elapsed = g_get_monotonic_time() - start_time;
+    g_autoptr(GString) stats = g_string_new("");
+
+    if (!do_callback) {
+        for (int i = 0; i < num_cpus; i++) {
+            qemu_plugin_record_buffer_flush(records, i);
+        }
+    }
+
+    g_string_append_printf(stats, "insn: %" PRIu64 " (inline)\n",
+                           qemu_plugin_u64_sum(insn_inline));
+    g_string_append_printf(stats, "insn: %" PRIu64 " (%s)\n",
+                           qemu_plugin_u64_sum(insn_count),
+                           do_callback ? "callback" : "records");
+    g_string_append_printf(stats, "mem: %" PRIu64 " (inline)\n",
+                           qemu_plugin_u64_sum(mem_inline));
+    g_string_append_printf(stats, "mem: %" PRIu64 " (%s)\n",
+                           qemu_plugin_u64_sum(mem_count),
+                           do_callback ? "callback" : "records");
+    if (!do_callback) {
+        g_string_append_printf(stats, "batches: %" PRIu64 " of up to %zu\n",
+                               qemu_plugin_u64_sum(batches), buffer_size);
+    }
+    g_string_append_printf(stats, "time: %" PRId64 " us\n", elapsed);
+    qemu_plugin_outs(stats->str);
+
+    g_assert(qemu_plugin_u64_sum(insn_count) ==
+             qemu_plugin_u64_sum(insn_inline));
+    g_assert(qemu_plugin_u64_sum(mem_count) ==
+             qemu_plugin_u64_sum(mem_inline));
+
+    if (records) {
+        qemu_plugin_record_buffer_free(records);
+    }
+    qemu_plugin_scoreboard_free(counts);
+}
+
+QEMU_PLUGIN_EXPORT
+int qemu_plugin_install(qemu_plugin_id_t id, const qemu_info_t *info,
+                        int argc, char **argv)
+{
+    for (int i = 0; i < argc; i++) {
+        char *opt = argv[i];
+        g_auto(GStrv) tokens = g_strsplit(opt, "=", 2);
+
+        if (g_strcmp0(tokens[0], "size") == 0) {
+            buffer_size = g_ascii_strtoull(tokens[1], NULL, 0);
+            if (buffer_size == 0) {
+                fprintf(stderr, "invalid buffer size: %s\n", opt);
+                return -1;
+            }
+        } else if (g_strcmp0(tokens[0], "callback") == 0) {
+            if (!qemu_plugin_bool_parse(tokens[0], tokens[1], &do_callback)) {
+                fprintf(stderr, "boolean argument parsing failed: %s\n", opt);
+                return -1;
+            }
+        } else {
+            fprintf(stderr, "option parsing failed: %s\n", opt);
+            return -1;
+        }
+    }
+
+    counts = qemu_plugin_scoreboard_new(sizeof(CPUCount));
+    insn_inline = qemu_plugin_scoreboard_u64_in_struct(
+        counts, CPUCount, insn_inline);
+    mem_inline = qemu_plugin_scoreboard_u64_in_struct(
+        counts, CPUCount, mem_inline);
+    insn_count = qemu_plugin_scoreboard_u64_in_struct(counts, CPUCount, insn);
+    mem_count = qemu_plugin_scoreboard_u64_in_struct(counts, CPUCount, mem);
+    batches = qemu_plugin_scoreboard_u64_in_struct(counts, CPUCount, batches);
+
+    if (!do_callback) {
+        records = qemu_plugin_record_buffer_new(buffer_size, vcpu_records,
+                                                NULL);
+    }
+    start_time = g_get_monotonic_time();
+
+    qemu_plugin_register_vcpu_tb_trans_cb(id, vcpu_tb_trans, NULL);
+    qemu_plugin_register_atexit_cb(id, plugin_exit, NULL);
+    return 0;
+}
@@ -0,0 +1,60 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+/*
+ * Check unaligned locked operations from several threads
+ *
+ * Each thread increments counters that are misaligned but within a
+ * cache line with lock xadd, lock add and lock cmpxchg.  No increment
+ * may be lost.  Counters spanning two
+ * lines are avoided, as hosts may throttle or trap split locks.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#define THREADS     8
+#define ITERATIONS  20000
+
+static uint8_t mem[64] __attribute__((aligned(64)));
+
+#define CTR_XADD    ((uint64_t *)(mem + 4))
+#define CTR_ADD     ((uint64_t *)(mem + 35))
+#define CTR_CMPXCHG ((uint32_t *)(mem + 18))
+
+static void *thread_fn(void *arg)
+{
+    uint64_t one;
+    uint32_t old, new;
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        one = 1;
+        asm volatile("lock xaddq %0, %1" : "+r"(one), "+m"(*CTR_XADD));
+        asm volatile("lock addq $1, %0" : "+m"(*CTR_ADD));
+        old = *(volatile uint32_t *)CTR_CMPXCHG;
+        do {
+            new = old + 1;
+            asm volatile("lock cmpxchgl %2, %1"
+                         : "+a"(old), "+m"(*CTR_CMPXCHG) : "r"(new));
+        } while (old + 1 != new);
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    pthread_t threads[THREADS];
+
+    for (int i = 0; i < THREADS; i++) {
+        int ret = pthread_create(&threads[i], NULL, thread_fn, NULL);
+        assert(ret == 0);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    assert(*CTR_XADD == (uint64_t)THREADS * ITERATIONS);
+    assert(*CTR_ADD == (uint64_t)THREADS * ITERATIONS);
+    assert(*CTR_CMPXCHG == THREADS * ITERATIONS);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,122 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+/*
+ * Check and time TLB fills and flushes within 2MB pages
+ *
+ * The boot code identity maps memory with 2MB pages. Every 4KB piece
+ * of one such page is touched, then its PDE is redirected to another
+ * 2MB page and a single address is invalidated with invlpg, which must
+ * drop the translation of the whole 2MB page. The rdtsc ticks spent
+ * filling the pieces, and re-reading another huge page after an
+ * unrelated invlpg, are reported.
+ */
+
+#include <stdint.h>
+#include <minilib.h>
+
+#define HUGE_SHIFT      21
+#define HUGE_SIZE       (1ul << HUGE_SHIFT)
+#define PIECES          (int)(HUGE_SIZE / 4096)
+#define ITERATIONS      100
+
+static uint8_t buf[3 * HUGE_SIZE] __attribute__((aligned(HUGE_SIZE)));
+
+static inline uint64_t rdtsc(void)
+{
+    uint32_t lo, hi;
+
+    asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static inline void invlpg(void *addr)
+{
+    asm volatile("invlpg (%0)" : : "r"(addr) : "memory");
+}
+
+/* The boot code maps memory 1:1, so table addresses can be used as is. */
+static uint64_t *pde_for(void *addr)
+{
+    uintptr_t va = (uintptr_t)addr;
+    uint64_t *table;
+    uintptr_t cr3;
+
+    asm volatile("mov %%cr3, %0" : "=r"(cr3));
+    table = (uint64_t *)(cr3 & ~0xffful);
+    table = (uint64_t *)(table[(va >> 39) & 511] & ~0xffful);
+    table = (uint64_t *)(table[(va >> 30) & 511] & ~0xffful);
+    return &table[(va >> HUGE_SHIFT) & 511];
+}
+
+static void fill(uint8_t *page, int tag)
+{
+    for (int i = 0; i < PIECES; i++) {
+        page[i * 4096] = tag + i;
+    }
+}
+
+static int check(volatile uint8_t *page, int tag)
+{
+    int bad = 0;
+
+    for (int i = 0; i < PIECES; i++) {
+        if (page[i * 4096] != (uint8_t)(tag + i)) {
+            bad++;
+        }
+    }
+    return bad;
+}
+
+static uint64_t bench_touch(volatile uint8_t *page, void *flush)
+{
+    uint64_t start = rdtsc();
+
+    for (int n = 0; n < ITERATIONS; n++) {
+        if (flush) {
+            invlpg(flush);
+        }
+        for (int i = 0; i < PIECES; i++) {
+            (void)page[i * 4096];
+        }
+    }
+    return rdtsc() - start;
+}
+
+int main(void)
+{
+    uint8_t *a = buf, *b = buf + HUGE_SIZE, *c = buf + 2 * HUGE_SIZE;
+    uint64_t *pde_a = pde_for(a);
+    uint64_t old = *pde_a;
+    uint64_t ticks;
+    int bad;
+
+    if (!(old & 0x80)) {
+        ml_printf("FAIL: buffer is not mapped with 2MB pages\n");
+        return 1;
+    }
+
+    fill(a, 0x10);
+    fill(b, 0x80);
+    bad = check(a, 0x10);
+
+    /* Redirect a to b; one invlpg must cover the whole 2MB page. */
+    *pde_a = *pde_for(b);
+    invlpg(a + 5 * 4096);
+    bad += check(a, 0x80);
+
+    *pde_a = old;
+    invlpg(a + PIECES / 2 * 4096);
+    bad += check(a, 0x10);
+    if (bad) {
+        ml_printf("FAIL: %d of %d pieces used a stale translation\n",
+                  bad, 3 * PIECES);
+        return 1;
+    }
+
+    ticks = bench_touch(c, NULL);
+    ml_printf("touch:          %lu ticks for %d pages\n",
+              (unsigned long)ticks, ITERATIONS * PIECES);
+    ticks = bench_touch(c, a);
+    ml_printf("touch + invlpg: %lu ticks for %d pages\n",
+              (unsigned long)ticks, ITERATIONS * PIECES);
+    return 0;
+}